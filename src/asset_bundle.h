@@ -0,0 +1,215 @@
+#ifndef ASSET_BUNDLE_H
+#define ASSET_BUNDLE_H
+
+//packed asset bundle written by tools/asset_packer.cpp: every sprite already decoded to RGBA32 and the font file,
+//in one file that is memory mapped at startup instead of opening and decoding each asset on its own
+//layout: a BUNDLE_HEADER_SIZE byte header, the index, then the assets' data, each at a BUNDLE_ALIGNMENT aligned offset
+//header: magic, version, two zero bytes, entry count, index size; version 1 had a 16 bit count and no padding
+//index entry: kind, path length, width, height, data offset, data size, then the path, which is the one the game
+//would otherwise load the asset from (e.g. assets/sprites/objects/copper_ore.png)
+//integers are little endian; a bundle of another version is ignored and the loose files are loaded instead
+//a loose file written after the bundle was is an edit the bundle does not have, its entry is then not used
+
+#include "save_file.h"
+
+constexpr std::array<char, 4> BUNDLE_MAGIC = {'S', 'Q', 'P', 'K'};
+constexpr std::uint16_t BUNDLE_VERSION = 2;
+constexpr size_t BUNDLE_HEADER_SIZE = 16;
+//an index entry without its path
+constexpr size_t BUNDLE_ENTRY_SIZE = 28;
+//keeps pixel rows of every image aligned for the blitter
+constexpr size_t BUNDLE_ALIGNMENT = 64;
+constexpr const char* ASSET_BUNDLE_PATH = "assets/assets.pack";
+
+enum class BundleKind : std::uint8_t
+{
+    IMAGE, //width * height RGBA32 pixels, rows packed
+    FILE //the file's bytes as they are
+};
+
+struct BundleEntry
+{
+    BundleKind kind;
+    std::string_view path;
+    std::uint32_t width;
+    std::uint32_t height;
+    const std::uint8_t *data;
+    size_t size;
+};
+
+class BundleWriter
+{
+    struct Pending
+    {
+        BundleKind kind;
+        std::string path;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::vector<std::uint8_t> data;
+    };
+
+    std::vector<Pending> entries;
+
+    static void putLE(std::vector<std::uint8_t>& out, std::uint64_t value, size_t n)
+    {
+        for(size_t i=0; i<n; i++)
+            out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+
+    static size_t align(size_t offset) noexcept
+    {
+        return (offset + BUNDLE_ALIGNMENT - 1) / BUNDLE_ALIGNMENT * BUNDLE_ALIGNMENT;
+    }
+
+    public:
+        //pixels are width * height RGBA32 values, rows packed
+        void addImage(std::string path, std::uint32_t width, std::uint32_t height, std::vector<std::uint8_t> pixels)
+        {
+            entries.push_back({BundleKind::IMAGE, std::move(path), width, height, std::move(pixels)});
+        }
+
+        void addFile(std::string path, std::vector<std::uint8_t> bytes)
+        {
+            entries.push_back({BundleKind::FILE, std::move(path), 0, 0, std::move(bytes)});
+        }
+
+        size_t size() const noexcept
+        {
+            return entries.size();
+        }
+
+        std::vector<std::uint8_t> finish() const
+        {
+            std::vector<std::uint8_t> index;
+            size_t data_offset = 0;
+            for(const Pending& entry : entries)
+                data_offset += BUNDLE_ENTRY_SIZE + entry.path.size();
+            data_offset = align(BUNDLE_HEADER_SIZE + data_offset);
+            for(const Pending& entry : entries)
+            {
+                putLE(index, static_cast<std::uint8_t>(entry.kind), 1);
+                putLE(index, 0, 1);
+                putLE(index, entry.path.size(), 2);
+                putLE(index, entry.width, 4);
+                putLE(index, entry.height, 4);
+                putLE(index, data_offset, 8);
+                putLE(index, entry.data.size(), 8);
+                index.insert(index.end(), entry.path.begin(), entry.path.end());
+                data_offset = align(data_offset + entry.data.size());
+            }
+
+            std::vector<std::uint8_t> bytes(BUNDLE_MAGIC.begin(), BUNDLE_MAGIC.end());
+            putLE(bytes, BUNDLE_VERSION, 2);
+            putLE(bytes, 0, 2);
+            putLE(bytes, entries.size(), 4);
+            putLE(bytes, index.size(), 4);
+            bytes.insert(bytes.end(), index.begin(), index.end());
+            for(const Pending& entry : entries)
+            {
+                bytes.resize(align(bytes.size()), 0);
+                bytes.insert(bytes.end(), entry.data.begin(), entry.data.end());
+            }
+            return bytes;
+        }
+};
+
+//validates a mapped bundle and hands out its entries without copying them, they stay valid until close
+class AssetBundle
+{
+    MappedFile file;
+    std::vector<BundleEntry> entries;
+    std::unordered_map<std::string_view, size_t> by_path;
+    //when the bundle file was last written
+    std::filesystem::file_time_type written;
+
+    public:
+        AssetBundle(){}
+
+        AssetBundle(const AssetBundle&) = delete;
+        AssetBundle& operator=(const AssetBundle&) = delete;
+
+        //false if there is no bundle or it cannot be used, the error is only reported for a damaged one
+        bool open(const std::filesystem::path& path)
+        {
+            close();
+            std::error_code ec;
+            if(!std::filesystem::exists(path, ec) || !file.open(path))
+                return false;
+            ByteReader header{file.getData(), file.getSize()};
+            std::string_view magic = header.getBytes(BUNDLE_MAGIC.size());
+            std::uint16_t version = header.get16();
+            header.get16();
+            std::uint32_t count = header.get32();
+            std::uint32_t index_size = header.get32();
+            if(!header.ok || magic != std::string_view(BUNDLE_MAGIC.data(), BUNDLE_MAGIC.size()) || version != BUNDLE_VERSION)
+            {
+                std::cerr<<"Ignoring asset bundle "<<path.string()<<": not a version "<<BUNDLE_VERSION<<" bundle\n";
+                close();
+                return false;
+            }
+            ByteReader index{file.getData(), std::min(file.getSize(), BUNDLE_HEADER_SIZE + index_size), BUNDLE_HEADER_SIZE};
+            entries.reserve(std::min<size_t>(count, index_size / BUNDLE_ENTRY_SIZE));
+            for(std::uint32_t i=0; i<count; i++)
+            {
+                BundleKind kind = static_cast<BundleKind>(index.get8());
+                index.get8();
+                std::uint16_t path_size = index.get16();
+                std::uint32_t width = index.get32();
+                std::uint32_t height = index.get32();
+                std::uint64_t offset = index.get64();
+                std::uint64_t size = index.get64();
+                std::string_view entry_path = index.getBytes(path_size);
+                bool valid = index.ok && offset <= file.getSize() && size <= file.getSize() - offset;
+                if(kind == BundleKind::IMAGE)
+                    valid = valid && offset % BUNDLE_ALIGNMENT == 0 && size == static_cast<std::uint64_t>(width) * height * 4;
+                else
+                    valid = valid && kind == BundleKind::FILE;
+                if(!valid)
+                {
+                    std::cerr<<"Ignoring asset bundle "<<path.string()<<": damaged index\n";
+                    close();
+                    return false;
+                }
+                by_path.emplace(entry_path, entries.size());
+                entries.push_back({kind, entry_path, width, height, file.getData() + offset, static_cast<size_t>(size)});
+            }
+            written = std::filesystem::last_write_time(path, ec);
+            if(ec)
+                written = std::filesystem::file_time_type::max();
+            return true;
+        }
+
+        void close() noexcept
+        {
+            by_path.clear();
+            entries.clear();
+            file.close();
+        }
+
+        bool isOpen() const noexcept
+        {
+            return file.getData() != nullptr;
+        }
+
+        const std::vector<BundleEntry>& getEntries() const noexcept
+        {
+            return entries;
+        }
+
+        const BundleEntry* find(std::string_view path) const noexcept
+        {
+            auto it = by_path.find(path);
+            return it == by_path.end() ? nullptr : &entries[it->second];
+        }
+
+        //false when the loose file the entry was packed from has been written since the bundle was, so the
+        //bundle holds an older copy of it; an entry without a loose file is current
+        bool isCurrent(const BundleEntry& entry) const
+        {
+            std::error_code ec;
+            std::filesystem::file_time_type loose = std::filesystem::last_write_time(std::filesystem::path(entry.path), ec);
+            return ec || loose <= written;
+        }
+};
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+//gets every registered sprite into a surface for the atlas: sprites in the asset bundle are wrapped where they lie
+//in the mapping, any other is decoded from its PNG on a pool of worker threads, so the menus can be shown while
+//that runs; surfaces are handed to the render thread once ready() says all workers are done
+//a PNG edited since the bundle was packed is decoded instead of taking the bundle's older pixels
+
+#include "constants.h"
+#include "sprite_registry.h"
+#include "asset_bundle.h"
+#include <atomic>
+#include <thread>
+
+class AssetLoader
+{
+    AssetBundle bundle;
+    //by SpriteID, nullptr where a sprite could not be loaded
+    std::vector<SDL_Surface*> surfaces;
+    //sprites to decode and the next one a worker takes
+    std::vector<std::pair<SpriteID, std::string>> pending;
+    std::atomic<size_t> next_pending{0};
+    std::atomic<size_t> remaining{0};
+    std::vector<std::thread> workers;
+    size_t from_bundle = 0;
+    Uint64 start_ns = 0;
+    //set by whichever worker finishes the last sprite
+    std::atomic<Uint64> ready_ns{0};
+
+    void registerDirectory(const std::string& dir_path) const
+    {
+        int count = 0;
+        char **files = SDL_GlobDirectory(dir_path.c_str(), "*.png", 0, &count);
+        if(!files)
+            return;
+        for(int i=0; i<count; i++)
+            register_sprite(dir_path + files[i]);
+        SDL_free(files);
+    }
+
+    void decode() noexcept
+    {
+        for(size_t i = next_pending.fetch_add(1, std::memory_order_relaxed); i < pending.size();
+            i = next_pending.fetch_add(1, std::memory_order_relaxed))
+        {
+            SDL_Surface *surface = IMG_Load(pending[i].second.c_str());
+            if(!surface)
+                std::cerr<<"Failed to load sprite "<<pending[i].second<<": "<<SDL_GetError()<<"\n";
+            surfaces[pending[i].first] = surface;
+            if(remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                ready_ns.store(SDL_GetTicksNS(), std::memory_order_relaxed);
+        }
+    }
+
+    public:
+        AssetLoader(){}
+
+        AssetLoader(const AssetLoader&) = delete;
+        AssetLoader& operator=(const AssetLoader&) = delete;
+
+        ~AssetLoader()
+        {
+            wait();
+            releaseSurfaces();
+        }
+
+        //maps the bundle if there is one, registers every sprite and starts decoding the ones it does not hold
+        //with up to max_threads workers, 0 for one per hardware thread; an empty bundle path loads only loose files
+        //starting again unmaps the previous bundle, so a font opened from it has to be closed first
+        void start(const std::filesystem::path& bundle_path = ASSET_BUNDLE_PATH, unsigned max_threads = 0)
+        {
+            wait();
+            releaseSurfaces();
+            start_ns = SDL_GetTicksNS();
+            ready_ns.store(0, std::memory_order_relaxed);
+            from_bundle = 0;
+            bundle.close();
+            if(!bundle_path.empty() && bundle.open(bundle_path))
+            {
+                for(const BundleEntry& entry : bundle.getEntries())
+                    if(entry.kind == BundleKind::IMAGE)
+                        register_sprite(std::string(entry.path));
+            }
+            //sprites added since the bundle was packed are still picked up
+            registerDirectory(ASSET_SPRITE_PATH_OBJECTS);
+            registerDirectory(ASSET_SPRITE_PATH_RESOURCES);
+
+            const std::vector<std::string>& registry = sprite_registry();
+            surfaces.assign(registry.size(), nullptr);
+            pending.clear();
+            for(size_t i=0; i<registry.size(); i++)
+            {
+                const BundleEntry *entry = bundle.find(registry[i]);
+                if(entry && entry->kind == BundleKind::IMAGE && bundle.isCurrent(*entry))
+                {
+                    surfaces[i] = SDL_CreateSurfaceFrom(static_cast<int>(entry->width), static_cast<int>(entry->height), SDL_PIXELFORMAT_RGBA32,
+                        const_cast<std::uint8_t*>(entry->data), static_cast<int>(entry->width * 4));
+                    if(surfaces[i])
+                    {
+                        from_bundle++;
+                        continue;
+                    }
+                }
+                pending.emplace_back(i, registry[i]);
+            }
+
+            next_pending.store(0, std::memory_order_relaxed);
+            remaining.store(pending.size(), std::memory_order_relaxed);
+            if(pending.empty())
+                ready_ns.store(SDL_GetTicksNS(), std::memory_order_relaxed);
+            unsigned threads = max_threads ? max_threads : std::max(1u, std::thread::hardware_concurrency());
+            threads = static_cast<unsigned>(std::min<size_t>(threads, pending.size()));
+            for(unsigned i=0; i<threads; i++)
+                workers.emplace_back([this]{ decode(); });
+        }
+
+        bool ready() const noexcept
+        {
+            return remaining.load(std::memory_order_acquire) == 0;
+        }
+
+        //blocks until every sprite is decoded
+        void wait()
+        {
+            for(std::thread& worker : workers)
+                worker.join();
+            workers.clear();
+        }
+
+        //by SpriteID, only complete once ready()
+        const std::vector<SDL_Surface*>& getSurfaces() const noexcept
+        {
+            return surfaces;
+        }
+
+        //frees the surfaces once they are in the atlas, the bundle stays mapped for the font
+        void releaseSurfaces() noexcept
+        {
+            for(SDL_Surface *surface : surfaces)
+                if(surface)
+                    SDL_DestroySurface(surface);
+            surfaces.clear();
+        }
+
+        //opens the font from the bundle if it holds a current copy of the file at path, otherwise from disk
+        TTF_Font* openFont(const char *path, float size) const
+        {
+            const BundleEntry *entry = bundle.find(path);
+            if(entry && entry->kind == BundleKind::FILE && bundle.isCurrent(*entry))
+            {
+                SDL_IOStream *stream = SDL_IOFromConstMem(entry->data, entry->size);
+                if(stream)
+                    return TTF_OpenFontIO(stream, true, size);
+            }
+            return TTF_OpenFont(path, size);
+        }
+
+        size_t getFromBundle() const noexcept
+        {
+            return from_bundle;
+        }
+
+        size_t getDecoded() const noexcept
+        {
+            return pending.size();
+        }
+
+        //time from start to every sprite being ready, 0 until wait() has returned
+        Uint64 getLoadNs() const noexcept
+        {
+            Uint64 ready = ready_ns.load(std::memory_order_relaxed);
+            return ready ? ready - start_ns : 0;
+        }
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+//background save writer
+//the main thread serializes the game into a SaveWriter at a tick boundary, which is the snapshot and costs
+//microseconds; the file write, fsync and rename then happen on a worker thread so frames never wait on the disk
+//requests for a path that is still queued replace the queued bytes, so a burst of saves writes only the latest one
+
+#include "save_file.h"
+#include "profiler.h"
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+struct SaveResult
+{
+    std::filesystem::path path;
+    bool ok;
+    std::uint64_t duration_us;
+    std::uint64_t tag; //whatever the caller passed to submit, the latest one when saves were coalesced
+};
+
+class Autosaver
+{
+    struct Job
+    {
+        std::filesystem::path path;
+        std::vector<std::uint8_t> bytes;
+        std::uint64_t tag;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Job> pending;
+    std::vector<SaveResult> completed;
+    bool writing = false;
+    bool stopping = false;
+    std::thread worker;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(true)
+        {
+            wake.wait(lock, [this]{ return stopping || !pending.empty(); });
+            if(pending.empty())
+                return;
+            Job job = std::move(pending.front());
+            pending.erase(pending.begin());
+            writing = true;
+            lock.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            bool ok;
+            {
+                PROFILE_ZONE("Autosaver::write");
+                ok = write_file_atomically(job.path, job.bytes);
+            }
+            std::uint64_t duration_us = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+
+            lock.lock();
+            writing = false;
+            completed.push_back({std::move(job.path), ok, duration_us, job.tag});
+            wake.notify_all();
+        }
+    }
+
+    public:
+        Autosaver() : worker([this]{ run(); })
+        {}
+
+        Autosaver(const Autosaver&) = delete;
+        Autosaver& operator=(const Autosaver&) = delete;
+
+        ~Autosaver()
+        {
+            shutdown();
+        }
+
+        void submit(const std::filesystem::path& path, SaveWriter& writer, std::uint64_t tag = 0)
+        {
+            std::vector<std::uint8_t> bytes = writer.takeBytes();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for(Job& job : pending)
+                    if(job.path == path)
+                    {
+                        job.bytes = std::move(bytes);
+                        job.tag = tag;
+                        return;
+                    }
+                pending.push_back({path, std::move(bytes), tag});
+            }
+            wake.notify_all();
+        }
+
+        //moves finished saves into results, meant to be called once per frame from the main thread
+        void pollCompleted(std::vector<SaveResult>& results)
+        {
+            results.clear();
+            std::lock_guard<std::mutex> lock(mutex);
+            results.swap(completed);
+        }
+
+        bool isBusy()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return writing || !pending.empty();
+        }
+
+        //blocks until everything queued is on disk
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]{ return !writing && pending.empty(); });
+        }
+
+        //writes whatever is still queued, then stops the worker
+        void shutdown()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(stopping)
+                    return;
+                stopping = true;
+            }
+            wake.notify_all();
+            if(worker.joinable())
+                worker.join();
+        }
+};
+
+#endif
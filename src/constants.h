@@ -1,12 +1,11 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
-#include <iostream>
-#include <array>
-#include <vector>
+#include "game_data.h"
+#include "profiler.h"
+#include <cmath>
 #include <deque>
-#include <optional>
-#include <unordered_map>
+#include <list>
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
 #include <SDL3_image/SDL_image.h>
@@ -19,12 +18,29 @@ constexpr size_t SCREEN_HEIGHT = 768;
 constexpr const char* FONT_PATH = "assets/VT323-Regular.ttf";
 constexpr float FONT_SIZE = 24.0f;
 
-//assets
-const std::string ASSET_SPRITE_PATH_OBJECTS = "assets/sprites/objects/";
-const std::string ASSET_SPRITE_PATH_RESOURCES = "assets/sprites/resources/";
-
-//time constants
-constexpr Uint64 TICK = 600;
+//frame pacing
+constexpr Uint64 FPS = 60;
+constexpr Uint64 FRAME_NS = 1000000000 / FPS;
+constexpr Uint64 TICK_NS = TICK * 1000000;
+//the last part of a frame wait is spun instead of slept, as long as sleeps have lately been overshooting plus
+//FRAME_SPIN_MIN_NS, at most FRAME_SPIN_NS; sleeps overshoot by anything from tens of microseconds to a timer period
+constexpr Uint64 FRAME_SPIN_NS = 2000000;
+constexpr Uint64 FRAME_SPIN_MIN_NS = 100000;
+//let the display's vsync pace frames when the renderer supports it
+constexpr bool FRAME_VSYNC = false;
+//ticks run one by one in a single frame, the rest waits for the next frames or for fastForward
+constexpr std::uint64_t MAX_CATCHUP_TICKS = 4;
+//backlog beyond this is dropped instead of credited (a suspended process or a clock jump), one day of ticks
+constexpr std::uint64_t MAX_TICK_BACKLOG = 24 * 3600 * 1000 / TICK;
+#ifdef SKILLQUEST_PROFILE
+constexpr const char* PROFILE_TRACE_PATH = "profile_trace.json";
+#endif
+//frames kept for the jitter statistics
+constexpr size_t FRAME_HISTORY = 240;
+
+//sprite atlas
+constexpr size_t ATLAS_WIDTH = 512;
+constexpr size_t ATLAS_PADDING = 1;
 
 //menu dimensions
 constexpr size_t MAIN_MENU_BOX_WIDTH = 120;
@@ -33,6 +49,8 @@ constexpr size_t PAUSE_MENU_BOX_WIDTH = 205;
 constexpr size_t PAUSE_MENU_BOX_HEIGHT = static_cast<size_t>(FONT_SIZE * 3.0f + 0.2f * FONT_SIZE);
 constexpr size_t SAVE_MENU_BOX_WIDTH = 90;
 constexpr size_t SAVE_MENU_BOX_HEIGHT = static_cast<size_t>(FONT_SIZE * 3.0f + 0.2f * FONT_SIZE);
+constexpr size_t LOAD_MENU_BOX_WIDTH = 110;
+constexpr size_t LOAD_MENU_BOX_HEIGHT = static_cast<size_t>(FONT_SIZE * 4.0f + 0.2f * FONT_SIZE);
 
 //Grid
 constexpr size_t GRID_BOX_HEIGHT = 32;
@@ -46,8 +64,15 @@ constexpr float GS_X = 0;
 constexpr float GS_Y = 0;
 constexpr float GS_W = static_cast<float>(SCREEN_WIDTH) * 0.7f;
 constexpr float GS_H = static_cast<float>(SCREEN_HEIGHT) * 0.8f;
-constexpr size_t GS_cellsX = static_cast<size_t>((GS_W - GRID_LINE_WIDTH)/(GRID_LINE_WIDTH + GRID_BOX_WIDTH));
-constexpr size_t GS_cellsY = static_cast<size_t>((GS_H - GRID_LINE_WIDTH)/(GRID_LINE_WIDTH + GRID_BOX_HEIGHT));
+
+//world view: a tile is a grid box and the line above and left of it, this big at zoom 1
+constexpr float TILE_STEP_X = GRID_LINE_WIDTH + GRID_BOX_WIDTH;
+constexpr float TILE_STEP_Y = GRID_LINE_WIDTH + GRID_BOX_HEIGHT;
+constexpr float ZOOM_MIN = 0.25f;
+constexpr float ZOOM_MAX = 2.0f;
+constexpr float ZOOM_PER_NOTCH = 1.25f;
+//how far an arrow key moves the camera, in screen pixels
+constexpr float CAMERA_KEY_PAN = 4 * TILE_STEP_X;
 
 //text screen dimensions
 constexpr float TS_X = 0;
@@ -55,6 +80,17 @@ constexpr float TS_Y = GS_H;
 constexpr float TS_W = GS_W;
 constexpr float TS_H = static_cast<float>(SCREEN_HEIGHT) - GS_H;
 constexpr size_t NUM_LINES = static_cast<size_t>(TS_H / FONT_SIZE); 
+//laid out lines kept for scrolling back, and the most one line holds
+constexpr size_t SCROLLBACK_LINES = 4096;
+constexpr size_t TEXT_LINE_MAX_WORDS = 16;
+constexpr size_t TEXT_LINE_MAX_CHARS = 96;
+constexpr int SCROLL_LINES_PER_NOTCH = 3;
+//characters below this are measured from the cached advance table, the rest by TTF
+constexpr size_t GLYPH_ADVANCE_COUNT = 128;
+
+//rendered word textures kept alive, enough for a full text screen of words plus the menus
+constexpr size_t TEXT_CACHE_WORDS_PER_LINE = 16;
+constexpr size_t TEXT_CACHE_CAPACITY = NUM_LINES * TEXT_CACHE_WORDS_PER_LINE;
 
 //icons screen dimensions
 constexpr float IS_X = GS_W;
@@ -70,9 +106,6 @@ constexpr float UIS_H = static_cast<float>(SCREEN_HEIGHT) - IS_H;
 constexpr size_t UI_cellsX = static_cast<size_t>((UIS_W - GRID_LINE_WIDTH)/(GRID_LINE_WIDTH + GRID_BOX_WIDTH));
 constexpr size_t UI_cellsY = static_cast<size_t>((UIS_H - GRID_LINE_WIDTH)/(GRID_LINE_WIDTH + GRID_BOX_HEIGHT));
 
-//INVENTORY
-constexpr size_t INVENTORY_SIZE = 50;
-
 //Colors
 constexpr SDL_Color WHITE = {255, 255, 255, 255};
 constexpr SDL_Color BLACK = {0, 0, 0, 255};
@@ -81,138 +114,34 @@ constexpr SDL_Color YELLOW = {255, 255, 0, 255};
 constexpr SDL_Color ORANGE = {255, 165, 0, 255};
 constexpr SDL_Color RED = {255, 0, 0, 255};
 
+//bar under the mined resource showing how far the current tick is
+constexpr SDL_Color PROGRESS_BAR_COLOR = {240, 220, 120, 255};
+constexpr float PROGRESS_BAR_HEIGHT = 3.0f;
+//outline around the box under the mouse
+constexpr SDL_Color HOVER_BOX_COLOR = WHITE;
+
 enum class GameState : int
 {
     QUIT,
     RUNNING,
     MAIN,
     PAUSE,
-    SAVE
-};
-
-enum class PlayerState : int
-{
-    IDLE,
-    MINING
-};
-
-enum class ResourceName : int
-{
-    GROUND,
-    COPPER,
-    TIN,
-    IRON,
-    GOLD
-};
-
-enum class ObjectName : int
-{
-    STONE,
-    STICK,
-    COPPER_ORE,
-    TIN_ORE,
-    IRON_ORE,
-    GOLD_ORE
+    SAVE,
+    LOAD
 };
 
-enum class Rarity
-{
-    ALWAYS,
-    COMMON,
-    UNCOMMON,
-    RARE,
-    VERY_RARE
-};
-
-using enum PlayerState;
-using enum ResourceName;
-using enum ObjectName;
-using enum Rarity;
-
-std::string resource_name_to_string(ResourceName res_name)
-{
-    switch(res_name)
-    {
-        case GROUND: return "ground";
-        case COPPER: return "copper";
-        case TIN: return "tin";
-        case IRON: return "iron";
-        case GOLD: return "gold";
-        default: return "";
-    }
-}
-
-std::string object_name_to_string(ObjectName obj_name)
-{
-    switch(obj_name)
-    {
-        case STONE: return "stone";
-        case STICK: return "stick";
-        case COPPER_ORE: return "copper ore";
-        case TIN_ORE: return "tin ore";
-        case IRON_ORE: return "iron ore";
-        case GOLD_ORE: return "gold ore";
-        default: return "";
-    }
-}
-
-int level_exp_mapping(int level)
-{
-    switch(level)
-    {
-        case 1: return 0;
-        case 2: return 83;
-        case 3: return 174;
-        case 4: return 276;
-        case 5: return 388;
-        case 6: return 512;
-        case 7: return 650;
-        case 8: return 801;
-        case 9: return 969;
-        case 10: return 1154;
-        case 11: return 1358;
-        default: return 10000000;
-    }
-}
+//indexed by Rarity
+constexpr std::array<SDL_Color, 5> RARITY_COLORS = {WHITE, BROWN, YELLOW, ORANGE, RED};
+static_assert(RARITY_COLORS.size() == static_cast<size_t>(VERY_RARE) + 1, "every rarity needs a color");
 
-std::vector<Rarity> drop_rate_to_rarity(const std::vector<int>& drop_rates)
+constexpr SDL_Color rarity_to_color(Rarity rarity)
 {
-    std::vector<Rarity> res{};
-    res.reserve(drop_rates.size());
-    for(size_t i=0; i<drop_rates.size(); i++)
-    {
-        int drop_rate = drop_rates[i];
-        if(drop_rate > 500)
-            res.push_back(VERY_RARE);
-        else if(drop_rate > 125)
-            res.push_back(RARE);
-        else if(drop_rate > 40)
-            res.push_back(UNCOMMON);
-        else if(drop_rate > 1)
-            res.push_back(COMMON);
-        else
-            res.push_back(ALWAYS);
-    }
-    return res;
+    return RARITY_COLORS[static_cast<size_t>(rarity)];
 }
 
-std::vector<SDL_Color> rarity_to_color(const std::vector<Rarity>& rarity)
+constexpr Uint32 pack_color(SDL_Color color) noexcept
 {
-    std::vector<SDL_Color> res{};
-    res.reserve(rarity.size());
-    for(size_t i=0; i<rarity.size(); i++)
-    {
-        switch(rarity[i])
-        {
-            case ALWAYS: res.push_back(WHITE); break;
-            case COMMON: res.push_back(BROWN); break;
-            case UNCOMMON: res.push_back(YELLOW); break;
-            case RARE: res.push_back(ORANGE); break;
-            case VERY_RARE: res.push_back(RED); break;
-            default: res.push_back(WHITE);
-        }
-    }
-    return res;
+    return (static_cast<Uint32>(color.r) << 24) | (static_cast<Uint32>(color.g) << 16) | (static_cast<Uint32>(color.b) << 8) | color.a;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,561 @@
+#ifndef CONTENT_H
+#define CONTENT_H
+
+//the game's objects and resources, read from a text table instead of being compiled in, so adding content
+//never touches the code
+//everything is stored column by column and an ObjectId or ResourceId is the entry's index in every column;
+//a resource's drops are one contiguous run of the drop columns; the table owns the file's text and every key,
+//name and path is a view into it, so parsing allocates nothing beyond the columns, which a first pass over the
+//text sizes exactly
+//a table never changes once built, so both threads can share it; a reload builds a new one and swaps it in
+//
+//file format, one entry per line, # starts a comment:
+//  object KEY "NAME" SPRITE
+//  resource KEY "NAME" SPRITE OBJECT_KEY:DROP_RATE [OBJECT_KEY:DROP_RATE ...]
+//KEY is how saves and other lines refer to the entry, so it must not change once shipped; NAME is what the
+//player reads; SPRITE is relative to ASSET_SPRITE_PATH_OBJECTS or ASSET_SPRITE_PATH_RESOURCES; a drop rate of N
+//drops the object on one tick in N on average; objects must be defined before a resource drops them
+//ids follow the order of the lines, which is also the order resources are laid out on the game screen
+
+#include "game_data.h"
+#include "drop_sampler.h"
+#include "save_file.h"
+#include "sprite_registry.h"
+#include <bit>
+#include <charconv>
+#include <fstream>
+#include <memory>
+
+const std::string CONTENT_PATH = ASSET_DATA_PATH + "content.txt";
+
+//what the tools and a game without CONTENT_PATH run on, the same as the shipped file
+constexpr std::string_view DEFAULT_CONTENT = R"(
+object stone "stone" stone.png
+object stick "stick" stick.png
+object copper_ore "copper ore" copper_ore.png
+object tin_ore "tin ore" tin_ore.png
+object iron_ore "iron ore" iron_ore.png
+object gold_ore "gold ore" gold_ore.png
+
+resource copper "copper" copper.png copper_ore:5
+resource tin "tin" tin.png tin_ore:5
+resource iron "iron" iron.png iron_ore:5
+resource gold "gold" gold.png gold_ore:5
+)";
+
+//the ids saves used before they carried their keys (versions 1 and 2), when the content was compiled in
+constexpr std::array<std::string_view, 6> LEGACY_OBJECT_KEYS = {"stone", "stick", "copper_ore", "tin_ore", "iron_ore", "gold_ore"};
+constexpr std::array<std::string_view, 5> LEGACY_RESOURCE_KEYS = {"ground", "copper", "tin", "iron", "gold"};
+
+struct DropResult
+{
+    ObjectId object;
+    Rarity rarity;
+    size_t slot; //inventory slot the object went into
+};
+
+//a resource's drops, views into the content's drop columns
+struct ResourceDrops
+{
+    std::span<const ObjectId> objects;
+    std::span<const int> drop_rates;
+    std::span<const Rarity> rarities;
+
+    size_t size() const noexcept
+    {
+        return objects.size();
+    }
+};
+
+//ids of another table, a save's or the content before a reload, mapped to the current content's by key
+struct IdMap
+{
+    //NO_CONTENT_ID where the current content has no entry with that key
+    std::vector<std::uint16_t> objects;
+    std::vector<std::uint16_t> resources;
+
+    std::optional<ObjectId> object(std::uint32_t id) const noexcept
+    {
+        if(id >= objects.size() || objects[id] == NO_CONTENT_ID)
+            return std::nullopt;
+        return static_cast<ObjectId>(objects[id]);
+    }
+
+    std::optional<ResourceId> resource(std::uint32_t id) const noexcept
+    {
+        if(id >= resources.size() || resources[id] == NO_CONTENT_ID)
+            return std::nullopt;
+        return static_cast<ResourceId>(resources[id]);
+    }
+};
+
+//id of a key in O(1): open addressing over a power of two table sized once, holding ids into a key column
+class KeyIndex
+{
+    static constexpr std::uint32_t EMPTY = 0xFFFFFFFF;
+
+    std::vector<std::uint32_t> slots;
+
+    size_t home(std::string_view key) const noexcept
+    {
+        return std::hash<std::string_view>{}(key) & (slots.size() - 1);
+    }
+
+    public:
+        void reserve(size_t count)
+        {
+            slots.assign(std::bit_ceil(std::max<size_t>(count * 2, 2)), EMPTY);
+        }
+
+        //keys is the column the ids index, false if key is in it already
+        bool insert(std::string_view key, std::uint32_t id, const std::vector<std::string_view>& keys)
+        {
+            for(size_t i = home(key); ; i = (i + 1) & (slots.size() - 1))
+            {
+                if(slots[i] == EMPTY)
+                {
+                    slots[i] = id;
+                    return true;
+                }
+                if(keys[slots[i]] == key)
+                    return false;
+            }
+        }
+
+        std::optional<std::uint32_t> find(std::string_view key, const std::vector<std::string_view>& keys) const noexcept
+        {
+            if(slots.empty())
+                return std::nullopt;
+            for(size_t i = home(key); slots[i] != EMPTY; i = (i + 1) & (slots.size() - 1))
+                if(keys[slots[i]] == key)
+                    return slots[i];
+            return std::nullopt;
+        }
+};
+
+//the tokens of a line, separated by spaces; a token in double quotes may hold spaces
+struct LineTokens
+{
+    std::string_view rest;
+    bool unterminated = false; //a quote was never closed
+
+    //nullopt at the end of the line, "" gives an empty token
+    std::optional<std::string_view> next() noexcept
+    {
+        size_t start = rest.find_first_not_of(" \t\r");
+        if(start == std::string_view::npos)
+        {
+            rest = {};
+            return std::nullopt;
+        }
+        rest.remove_prefix(start);
+        std::string_view token;
+        size_t end;
+        if(rest[0] == '"')
+        {
+            end = rest.find('"', 1);
+            if(end == std::string_view::npos)
+            {
+                unterminated = true;
+                rest = {};
+                return std::nullopt;
+            }
+            token = rest.substr(1, end - 1);
+            end++;
+        }
+        else
+        {
+            end = std::min(rest.find_first_of(" \t\r"), rest.size());
+            token = rest.substr(0, end);
+        }
+        rest.remove_prefix(end);
+        return token;
+    }
+};
+
+class Content
+{
+    std::string text;
+    //objects, by ObjectId
+    std::vector<std::string_view> object_keys;
+    std::vector<std::string_view> object_names;
+    std::vector<std::string_view> object_paths; //relative to ASSET_SPRITE_PATH_OBJECTS
+    std::vector<SpriteID> object_sprites;
+    //resources, by ResourceId; resource r drops [drops_begin[r], drops_begin[r + 1]) of the drop columns
+    std::vector<std::string_view> resource_keys;
+    std::vector<std::string_view> resource_names;
+    std::vector<std::string_view> resource_paths; //relative to ASSET_SPRITE_PATH_RESOURCES
+    std::vector<SpriteID> resource_sprites;
+    std::vector<std::uint32_t> drops_begin = {0};
+    std::vector<DropSampler> samplers;
+    //the drops of every resource back to back
+    std::vector<ObjectId> drop_objects;
+    std::vector<int> drop_rates;
+    std::vector<Rarity> drop_rarities;
+    KeyIndex object_index;
+    KeyIndex resource_index;
+
+    Content(){}
+
+    //calls f(line, line_number) for every line of text with its comment cut off
+    template<typename F>
+    static void for_each_line(std::string_view text, F&& f)
+    {
+        size_t line_number = 1;
+        while(!text.empty())
+        {
+            size_t end = std::min(text.find('\n'), text.size());
+            std::string_view line = text.substr(0, end);
+            f(line.substr(0, line.find('#')), line_number++);
+            text.remove_prefix(std::min(end + 1, text.size()));
+        }
+    }
+
+    //sizes every column for what the text defines, lines are only checked by parseLine
+    void reserve()
+    {
+        size_t objects = 0;
+        size_t resources = 0;
+        size_t drops = 0;
+        for_each_line(text, [&](std::string_view line, size_t)
+        {
+            LineTokens tokens{line};
+            std::optional<std::string_view> keyword = tokens.next();
+            if(keyword == "object")
+                objects++;
+            else if(keyword == "resource")
+            {
+                resources++;
+                for(size_t i=0; i<3; i++)
+                    tokens.next();
+                while(tokens.next())
+                    drops++;
+            }
+        });
+        object_keys.reserve(objects);
+        object_names.reserve(objects);
+        object_paths.reserve(objects);
+        object_sprites.reserve(objects);
+        object_index.reserve(objects);
+        resource_keys.reserve(resources);
+        resource_names.reserve(resources);
+        resource_paths.reserve(resources);
+        resource_sprites.reserve(resources);
+        drops_begin.reserve(resources + 1);
+        samplers.reserve(resources);
+        resource_index.reserve(resources);
+        drop_objects.reserve(drops);
+        drop_rates.reserve(drops);
+        drop_rarities.reserve(drops);
+    }
+
+    //the name may be empty, the key and sprite may not
+    std::string parseObject(LineTokens& tokens)
+    {
+        std::optional<std::string_view> key = tokens.next();
+        std::optional<std::string_view> name = tokens.next();
+        std::optional<std::string_view> path = tokens.next();
+        if(!key || key->empty() || !name || !path || path->empty() || tokens.next() || tokens.unterminated)
+            return "expected: object KEY \"NAME\" SPRITE";
+        if(object_keys.size() == MAX_CONTENT_IDS)
+            return "more than MAX_CONTENT_IDS objects";
+        if(!object_index.insert(*key, static_cast<std::uint32_t>(object_keys.size()), object_keys))
+            return "object " + std::string(*key) + " is defined twice";
+        object_keys.push_back(*key);
+        object_names.push_back(*name);
+        object_paths.push_back(*path);
+        object_sprites.push_back(NO_SPRITE);
+        return "";
+    }
+
+    //the drops go straight into the drop columns and are taken back if the line turns out to be wrong
+    std::string parseResource(LineTokens& tokens)
+    {
+        std::optional<std::string_view> key = tokens.next();
+        std::optional<std::string_view> name = tokens.next();
+        std::optional<std::string_view> path = tokens.next();
+        if(!key || key->empty() || !name || !path || path->empty() || tokens.unterminated)
+            return "expected: resource KEY \"NAME\" SPRITE OBJECT_KEY:DROP_RATE...";
+        if(resource_keys.size() == MAX_CONTENT_IDS)
+            return "more than MAX_CONTENT_IDS resources";
+        if(resource_index.find(*key, resource_keys))
+            return "resource " + std::string(*key) + " is defined twice";
+
+        size_t first = drop_objects.size();
+        std::string error;
+        for(std::optional<std::string_view> token = tokens.next(); token && error.empty(); token = tokens.next())
+        {
+            std::string_view drop = *token;
+            if(drop.empty())
+            {
+                error = "empty drop";
+                break;
+            }
+            size_t colon = drop.find(':');
+            std::optional<std::uint32_t> object = object_index.find(drop.substr(0, std::min(colon, drop.size())), object_keys);
+            int drop_rate = 0;
+            const char *rate_end = drop.data() + drop.size();
+            bool rate_ok = colon != std::string_view::npos &&
+                std::from_chars(drop.data() + colon + 1, rate_end, drop_rate).ptr == rate_end && drop_rate >= 1;
+            if(!object)
+                error = "unknown object in " + std::string(drop);
+            else if(!rate_ok)
+                error = "drop rate in " + std::string(drop) + " must be a whole number of at least 1";
+            else if(drop_objects.size() - first == MAX_RESOURCE_DROPS)
+                error = "more than MAX_RESOURCE_DROPS drops";
+            else if(std::find(drop_objects.begin() + static_cast<std::ptrdiff_t>(first), drop_objects.end(), static_cast<ObjectId>(*object)) != drop_objects.end())
+                error = "object in " + std::string(drop) + " is dropped twice";
+            else
+            {
+                drop_objects.push_back(static_cast<ObjectId>(*object));
+                drop_rates.push_back(drop_rate);
+                drop_rarities.push_back(drop_rate_to_rarity(drop_rate));
+            }
+        }
+        if(error.empty() && tokens.unterminated)
+            error = "unterminated quote";
+        if(error.empty() && drop_objects.size() == first)
+            error = "resource " + std::string(*key) + " drops nothing";
+        if(!error.empty())
+        {
+            drop_objects.resize(first);
+            drop_rates.resize(first);
+            drop_rarities.resize(first);
+            return error;
+        }
+        resource_index.insert(*key, static_cast<std::uint32_t>(resource_keys.size()), resource_keys);
+        resource_keys.push_back(*key);
+        resource_names.push_back(*name);
+        resource_paths.push_back(*path);
+        resource_sprites.push_back(NO_SPRITE);
+        drops_begin.push_back(static_cast<std::uint32_t>(drop_objects.size()));
+        return "";
+    }
+
+    //why the line is not valid, or an empty string
+    std::string parseLine(std::string_view line)
+    {
+        LineTokens tokens{line};
+        std::optional<std::string_view> keyword = tokens.next();
+        if(!keyword)
+            return tokens.unterminated ? "unterminated quote" : "";
+        if(keyword == "object")
+            return parseObject(tokens);
+        if(keyword == "resource")
+            return parseResource(tokens);
+        return "unknown keyword \"" + std::string(*keyword) + "\"";
+    }
+
+    //the id in column of each of keys, NO_CONTENT_ID for keys it does not have
+    template<typename Keys>
+    static std::vector<std::uint16_t> map_ids(const Keys& keys, const KeyIndex& index, const std::vector<std::string_view>& column)
+    {
+        std::vector<std::uint16_t> ids(keys.size(), NO_CONTENT_ID);
+        for(size_t i=0; i<keys.size(); i++)
+            if(std::optional<std::uint32_t> id = index.find(keys[i], column))
+                ids[i] = static_cast<std::uint16_t>(*id);
+        return ids;
+    }
+
+    public:
+        Content(const Content&) = delete;
+        Content& operator=(const Content&) = delete;
+
+        //errors go to std::cerr as origin:line and give nullptr, so a half edited file never replaces a working table
+        static std::unique_ptr<Content> parse(std::string text, std::string_view origin)
+        {
+            std::unique_ptr<Content> content(new Content());
+            content->text = std::move(text);
+            content->reserve();
+            bool ok = true;
+            for_each_line(content->text, [&](std::string_view line, size_t line_number)
+            {
+                std::string error = content->parseLine(line);
+                if(error.empty())
+                    return;
+                std::cerr<<origin<<":"<<line_number<<": "<<error<<"\n";
+                ok = false;
+            });
+            if(!ok)
+                return nullptr;
+            for(size_t r=0; r<content->resource_keys.size(); r++)
+                content->samplers.emplace_back(content->drops(static_cast<ResourceId>(r)).drop_rates);
+            return content;
+        }
+
+        static std::unique_ptr<Content> load(const std::filesystem::path& path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if(!file)
+            {
+                std::cerr<<"Failed to open "<<path.string()<<"\n";
+                return nullptr;
+            }
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            return parse(std::move(text), path.string());
+        }
+
+        //DEFAULT_CONTENT, a fresh table the caller can still assign sprites to
+        static std::unique_ptr<Content> builtIn()
+        {
+            std::unique_ptr<Content> content = parse(std::string(DEFAULT_CONTENT), "built in content");
+            if(!content)
+                content.reset(new Content());
+            return content;
+        }
+
+        //DEFAULT_CONTENT without sprites, shared by every simulation that is not handed another table
+        static std::shared_ptr<const Content> defaults()
+        {
+            static const std::shared_ptr<const Content> built = builtIn();
+            return built;
+        }
+
+        //registers every sprite path, done by the render thread before the table is shared or the atlas built
+        void assignSprites()
+        {
+            for(size_t i=0; i<object_paths.size(); i++)
+                object_sprites[i] = register_sprite(ASSET_SPRITE_PATH_OBJECTS + std::string(object_paths[i]));
+            for(size_t i=0; i<resource_paths.size(); i++)
+                resource_sprites[i] = register_sprite(ASSET_SPRITE_PATH_RESOURCES + std::string(resource_paths[i]));
+        }
+
+        size_t objectCount() const noexcept
+        {
+            return object_keys.size();
+        }
+
+        size_t resourceCount() const noexcept
+        {
+            return resource_keys.size();
+        }
+
+        bool has(ObjectId object) const noexcept
+        {
+            return static_cast<size_t>(object) < object_keys.size();
+        }
+
+        bool has(ResourceId resource) const noexcept
+        {
+            return static_cast<size_t>(resource) < resource_keys.size();
+        }
+
+        //the accessors below take ids of this table, has() checks ids from elsewhere
+        std::string_view key(ObjectId object) const noexcept
+        {
+            return object_keys[static_cast<size_t>(object)];
+        }
+
+        std::string_view key(ResourceId resource) const noexcept
+        {
+            return resource_keys[static_cast<size_t>(resource)];
+        }
+
+        std::string_view name(ObjectId object) const noexcept
+        {
+            return object_names[static_cast<size_t>(object)];
+        }
+
+        std::string_view name(ResourceId resource) const noexcept
+        {
+            return resource_names[static_cast<size_t>(resource)];
+        }
+
+        std::string_view path(ObjectId object) const noexcept
+        {
+            return object_paths[static_cast<size_t>(object)];
+        }
+
+        std::string_view path(ResourceId resource) const noexcept
+        {
+            return resource_paths[static_cast<size_t>(resource)];
+        }
+
+        SpriteID sprite(ObjectId object) const noexcept
+        {
+            return object_sprites[static_cast<size_t>(object)];
+        }
+
+        SpriteID sprite(ResourceId resource) const noexcept
+        {
+            return resource_sprites[static_cast<size_t>(resource)];
+        }
+
+        ResourceDrops drops(ResourceId resource) const noexcept
+        {
+            size_t begin = drops_begin[static_cast<size_t>(resource)];
+            size_t count = drops_begin[static_cast<size_t>(resource) + 1] - begin;
+            return {std::span(drop_objects).subspan(begin, count), std::span(drop_rates).subspan(begin, count),
+                std::span(drop_rarities).subspan(begin, count)};
+        }
+
+        const DropSampler& sampler(ResourceId resource) const noexcept
+        {
+            return samplers[static_cast<size_t>(resource)];
+        }
+
+        std::optional<ObjectId> findObject(std::string_view key) const noexcept
+        {
+            std::optional<std::uint32_t> id = object_index.find(key, object_keys);
+            return id ? std::optional<ObjectId>(static_cast<ObjectId>(*id)) : std::nullopt;
+        }
+
+        std::optional<ResourceId> findResource(std::string_view key) const noexcept
+        {
+            std::optional<std::uint32_t> id = resource_index.find(key, resource_keys);
+            return id ? std::optional<ResourceId>(static_cast<ResourceId>(*id)) : std::nullopt;
+        }
+
+        //maps the ids of a table with these keys, in id order, to this table's
+        template<typename ObjectKeys, typename ResourceKeys>
+        IdMap mapKeys(const ObjectKeys& objects, const ResourceKeys& resources) const
+        {
+            return {map_ids(objects, object_index, object_keys), map_ids(resources, resource_index, resource_keys)};
+        }
+
+        //maps other's ids to this table's, for what was built on other before a reload
+        IdMap mapFrom(const Content& other) const
+        {
+            return mapKeys(other.object_keys, other.resource_keys);
+        }
+
+        //keys section: for objects then resources, a u32 count and every key as a u16 length and its bytes
+        void writeKeys(SaveWriter& writer) const
+        {
+            writer.beginSection(SAVE_TAG_KEYS);
+            for(const std::vector<std::string_view>* keys : {&object_keys, &resource_keys})
+            {
+                writer.put32(static_cast<std::uint32_t>(keys->size()));
+                for(std::string_view key : *keys)
+                {
+                    writer.put16(static_cast<std::uint16_t>(key.size()));
+                    writer.putBytes(key.data(), key.size());
+                }
+            }
+            writer.endSection();
+        }
+
+        //maps the ids a save was written with to this table's; what is missing from a damaged section maps to nothing
+        IdMap readKeys(const SaveReader& reader) const
+        {
+            if(reader.getVersion() < 3)
+                return mapKeys(LEGACY_OBJECT_KEYS, LEGACY_RESOURCE_KEYS);
+            std::optional<ByteReader> section = reader.section(SAVE_TAG_KEYS);
+            if(!section)
+                return {};
+            std::array<std::vector<std::string_view>, 2> keys;
+            for(std::vector<std::string_view>& column : keys)
+            {
+                std::uint32_t count = section->get32();
+                for(std::uint32_t i=0; i<count && section->ok; i++)
+                {
+                    std::string_view key = section->getBytes(section->get16());
+                    if(section->ok)
+                        column.push_back(key);
+                }
+            }
+            return mapKeys(keys[0], keys[1]);
+        }
+};
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef DROP_SAMPLER_H
+#define DROP_SAMPLER_H
+
+//precomputed drop tables, one per resource, so a tick costs the same however many objects a resource drops
+//every object rolls independently each tick with chance 1/drop_rate; instead of one roll per object:
+//- the number of ticks until at least one object drops is geometric with the chance that any does, so a
+//  countdown replaces the rolls on empty ticks
+//- on a drop tick the objects that drop are picked in index order, each pick being "which object is the next
+//  to drop after index k, if any", a fixed distribution drawn from a Walker alias table in O(1)
+//the outcome distribution is exactly that of the independent rolls
+
+#include "game_data.h"
+#include "random.h"
+#include <cmath>
+#include <limits>
+
+//draws one of n outcomes with given weights in O(1): one column pick and one biased coin
+class AliasTable
+{
+    std::vector<std::uint64_t> thresholds; //keep the column when next() is below its threshold
+    std::vector<std::uint32_t> aliases;
+
+    public:
+        AliasTable(){}
+
+        //weights must be non negative with a positive sum
+        explicit AliasTable(const std::vector<double>& weights) :
+        thresholds(weights.size(), std::numeric_limits<std::uint64_t>::max()),
+        aliases(weights.size())
+        {
+            size_t n = weights.size();
+            double sum = 0.0;
+            for(double weight : weights)
+                sum += weight;
+            std::vector<double> scaled(n);
+            std::vector<std::uint32_t> small, large;
+            for(size_t i=0; i<n; i++)
+            {
+                aliases[i] = static_cast<std::uint32_t>(i);
+                scaled[i] = weights[i] * static_cast<double>(n) / sum;
+                (scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+            }
+            while(!small.empty() && !large.empty())
+            {
+                std::uint32_t s = small.back();
+                small.pop_back();
+                std::uint32_t l = large.back();
+                thresholds[s] = static_cast<std::uint64_t>(std::ldexp(scaled[s], 64));
+                aliases[s] = l;
+                scaled[l] -= 1.0 - scaled[s];
+                if(scaled[l] < 1.0)
+                {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+            //whatever is left is 1 up to rounding and keeps its column
+        }
+
+        size_t size() const noexcept
+        {
+            return thresholds.size();
+        }
+
+        std::uint32_t sample(Rng& rng) const noexcept
+        {
+            std::uint32_t column = rng.bounded(static_cast<std::uint32_t>(thresholds.size()));
+            return rng.next() < thresholds[column] ? column : aliases[column];
+        }
+};
+
+class DropSampler
+{
+    size_t len = 0;
+    bool always = false; //some object drops every tick
+    double inv_log_miss = 0.0; //1 / log(chance that nothing drops in a tick)
+    //next_drop[k]: offset from k of the first object at or after k that drops this tick, len - k for none
+    std::vector<AliasTable> next_drop;
+    //first object to drop on a tick where something does
+    AliasTable first_drop;
+
+    public:
+        DropSampler(){}
+
+        //one drop rate per object a resource drops, each at least 1
+        explicit DropSampler(std::span<const int> drop_rates) : len(drop_rates.size()), next_drop(drop_rates.size() + 1)
+        {
+            std::vector<double> chance(len);
+            for(size_t i=0; i<len; i++)
+                chance[i] = 1.0 / drop_rates[i];
+
+            std::vector<double> weights;
+            for(size_t k=0; k<=len; k++)
+            {
+                //P(first drop after k is j) = chance[j] * product of misses from k to j-1
+                weights.assign(len - k + 1, 0.0);
+                double miss = 1.0;
+                for(size_t j=k; j<len; j++)
+                {
+                    weights[j - k] = chance[j] * miss;
+                    miss *= 1.0 - chance[j];
+                }
+                weights[len - k] = miss;
+                if(k == 0)
+                {
+                    always = (miss == 0.0);
+                    if(!always)
+                        inv_log_miss = 1.0 / std::log(miss);
+                    if(len > 0)
+                        first_drop = AliasTable(std::vector<double>(weights.begin(), weights.end() - 1));
+                }
+                next_drop[k] = AliasTable(weights);
+            }
+        }
+
+        bool empty() const noexcept
+        {
+            return len == 0;
+        }
+
+        //ticks up to and including the next tick on which something drops, capped at limit
+        std::uint64_t ticksToNextDrop(Rng& rng, std::uint64_t limit) const noexcept
+        {
+            if(len == 0)
+                return limit;
+            if(always)
+                return 1;
+            double wait = std::floor(std::log(rng.unit()) * inv_log_miss) + 1.0;
+            if(wait >= static_cast<double>(limit))
+                return limit;
+            return static_cast<std::uint64_t>(wait);
+        }
+
+        //for a tick on which something drops: calls on_drop(index) for every dropping object in index order,
+        //at least once; on_drop returns false to skip the rest of the tick
+        template<typename F>
+        void sampleDropTick(Rng& rng, F&& on_drop) const
+        {
+            if(len == 0)
+                return;
+            size_t index = first_drop.sample(rng);
+            while(index < len && on_drop(index))
+                index += 1 + next_drop[index + 1].sample(rng);
+        }
+};
+
+#endif
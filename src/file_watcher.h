@@ -0,0 +1,244 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+//calls back on its own thread with the files that changed in a set of directories
+//on Linux it sleeps on inotify and reacts to files being written or moved in, which covers editors that save
+//through a temporary file; elsewhere it compares modification times every FILE_WATCH_POLL
+//changes are collected until none arrived for FILE_WATCH_SETTLE (or the next poll), so a save that writes a
+//file several times is handled once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+constexpr std::chrono::milliseconds FILE_WATCH_SETTLE{50};
+constexpr std::chrono::milliseconds FILE_WATCH_POLL{500};
+
+class FileWatcher
+{
+    using Callback = std::function<void(const std::vector<std::string>&)>;
+
+    std::vector<std::string> directories;
+    Callback on_change;
+    std::thread worker;
+    std::atomic<bool> stopping{false};
+    //paths queued by touch, taken by the watcher thread with the next batch
+    std::mutex touched_mutex;
+    std::set<std::string> touched;
+#ifdef __linux__
+    int inotify_fd = -1;
+    //written by touch and stop to wake the watcher thread
+    int wake_fd = -1;
+    //directory of every inotify watch descriptor
+    std::map<int, std::string> watches;
+#else
+    std::condition_variable wake;
+    std::map<std::string, std::filesystem::file_time_type> times;
+#endif
+
+    void takeTouched(std::set<std::string>& changed)
+    {
+        std::lock_guard<std::mutex> lock(touched_mutex);
+        changed.merge(touched);
+        touched.clear();
+    }
+
+    void report(std::set<std::string>& changed)
+    {
+        if(changed.empty())
+            return;
+        on_change(std::vector<std::string>(changed.begin(), changed.end()));
+        changed.clear();
+    }
+
+#ifdef __linux__
+    void readEvents(std::set<std::string>& changed)
+    {
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while((length = read(inotify_fd, buffer, sizeof(buffer))) > 0)
+        {
+            for(char *at = buffer; at < buffer + length; )
+            {
+                const inotify_event *event = reinterpret_cast<const inotify_event*>(at);
+                auto dir = watches.find(event->wd);
+                if(event->len > 0 && dir != watches.end())
+                    changed.insert(dir->second + event->name);
+                at += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+
+    void run()
+    {
+        std::set<std::string> changed;
+        pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+        while(!stopping.load(std::memory_order_acquire))
+        {
+            //blocks until something changes, then waits for the changes to settle
+            int timeout = changed.empty() ? -1 : static_cast<int>(FILE_WATCH_SETTLE.count());
+            int ready = poll(fds, 2, timeout);
+            if(ready < 0)
+                continue;
+            if(ready == 0)
+            {
+                report(changed);
+                continue;
+            }
+            if(fds[1].revents & POLLIN)
+            {
+                std::uint64_t count;
+                (void)!read(wake_fd, &count, sizeof(count));
+                takeTouched(changed);
+            }
+            if(fds[0].revents & POLLIN)
+                readEvents(changed);
+        }
+    }
+#else
+    void scan(std::set<std::string>& changed)
+    {
+        std::error_code ec;
+        for(const std::string& dir : directories)
+        {
+            for(const auto& entry : std::filesystem::directory_iterator(dir, ec))
+            {
+                std::string path = dir + entry.path().filename().string();
+                std::filesystem::file_time_type time = entry.last_write_time(ec);
+                auto [it, added] = times.emplace(path, time);
+                if(added || it->second != time)
+                {
+                    it->second = time;
+                    changed.insert(path);
+                }
+            }
+        }
+    }
+
+    void run()
+    {
+        //the first scan only learns what is there
+        std::set<std::string> changed;
+        scan(changed);
+        changed.clear();
+        while(!stopping.load(std::memory_order_acquire))
+        {
+            {
+                std::unique_lock<std::mutex> lock(touched_mutex);
+                wake.wait_for(lock, FILE_WATCH_POLL, [this]{ return stopping.load(std::memory_order_acquire) || !touched.empty(); });
+            }
+            takeTouched(changed);
+            scan(changed);
+            report(changed);
+        }
+    }
+#endif
+
+    public:
+        FileWatcher(){}
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        ~FileWatcher()
+        {
+            stop();
+        }
+
+        //dir ends in a separator, reported paths are dir followed by the file name; call before start
+        void watch(const std::string& dir)
+        {
+            directories.push_back(dir);
+        }
+
+        //false if no directory could be watched, there is nothing to report then
+        bool start(Callback callback)
+        {
+            if(worker.joinable())
+                return true;
+            on_change = std::move(callback);
+            stopping.store(false, std::memory_order_relaxed);
+#ifdef __linux__
+            inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if(inotify_fd < 0 || wake_fd < 0)
+            {
+                std::cerr<<"Failed to start watching files\n";
+                stop();
+                return false;
+            }
+            for(const std::string& dir : directories)
+            {
+                int wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                if(wd >= 0)
+                    watches.emplace(wd, dir);
+            }
+            if(watches.empty())
+            {
+                stop();
+                return false;
+            }
+#endif
+            worker = std::thread([this]{ run(); });
+            return true;
+        }
+
+        //reports path with the next batch as if it had changed
+        void touch(const std::string& path)
+        {
+            {
+                std::lock_guard<std::mutex> lock(touched_mutex);
+                touched.insert(path);
+            }
+#ifdef __linux__
+            std::uint64_t one = 1;
+            if(wake_fd >= 0)
+                (void)!write(wake_fd, &one, sizeof(one));
+#else
+            wake.notify_one();
+#endif
+        }
+
+        void stop()
+        {
+            stopping.store(true, std::memory_order_release);
+#ifdef __linux__
+            std::uint64_t one = 1;
+            if(wake_fd >= 0)
+                (void)!write(wake_fd, &one, sizeof(one));
+#else
+            {
+                std::lock_guard<std::mutex> lock(touched_mutex);
+                wake.notify_one();
+            }
+#endif
+            if(worker.joinable())
+                worker.join();
+#ifdef __linux__
+            if(inotify_fd >= 0)
+                close(inotify_fd);
+            if(wake_fd >= 0)
+                close(wake_fd);
+            inotify_fd = -1;
+            wake_fd = -1;
+            watches.clear();
+#endif
+        }
+};
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+//fixed timestep loop timing on SDL's nanosecond clock
+//simulation time is handed out in whole ticks from an accumulator, the remainder is the interpolation
+//fraction for rendering; frames are paced to absolute deadlines so rounding never adds up to drift, by
+//sleeping most of the wait and spinning only the last stretch a sleep cannot hit reliably, which is learnt from
+//how late sleeps wake up so an idle game keeps a core busy for a fraction of a millisecond per frame
+//with vsync the present call paces frames and no waiting happens here
+//a scheduler made without a tick length only paces frames, the simulation thread runs its own for ticks
+
+#include "constants.h"
+
+class FrameScheduler
+{
+    Uint64 tick_ns;
+    Uint64 frame_ns;
+    std::uint64_t max_backlog;
+    bool vsync = false;
+    Uint64 last = 0;
+    Uint64 next_frame = 0;
+    Uint64 accumulator = 0;
+    std::uint64_t dropped_ticks = 0;
+    //how long before a deadline the wait stops sleeping, starts high and follows the sleeps' overshoot
+    Uint64 spin_ns = FRAME_SPIN_NS;
+    //start to start intervals of the last FRAME_HISTORY frames
+    std::array<Uint64, FRAME_HISTORY> intervals{};
+    size_t interval_count = 0;
+    size_t interval_pos = 0;
+
+    public:
+        FrameScheduler(Uint64 tick_ns, Uint64 frame_ns, std::uint64_t max_backlog) :
+        tick_ns(tick_ns),
+        frame_ns(frame_ns),
+        max_backlog(max_backlog)
+        {}
+
+        explicit FrameScheduler(Uint64 frame_ns) : FrameScheduler(0, frame_ns, 0)
+        {}
+
+        void start() noexcept
+        {
+            last = SDL_GetTicksNS();
+            next_frame = last;
+            accumulator = 0;
+            interval_count = 0;
+            interval_pos = 0;
+        }
+
+        void setVsync(bool enabled) noexcept
+        {
+            vsync = enabled;
+        }
+
+        bool isVsync() const noexcept
+        {
+            return vsync;
+        }
+
+        //adds the time since the last frame to the tick backlog
+        void beginFrame() noexcept
+        {
+            Uint64 now = SDL_GetTicksNS();
+            Uint64 delta = now - last;
+            last = now;
+            intervals[interval_pos] = delta;
+            interval_pos = (interval_pos + 1) % FRAME_HISTORY;
+            interval_count = std::min(interval_count + 1, FRAME_HISTORY);
+
+            if(tick_ns == 0)
+                return;
+            accumulator += delta;
+            if(accumulator / tick_ns > max_backlog)
+            {
+                dropped_ticks += accumulator / tick_ns - max_backlog;
+                accumulator = max_backlog * tick_ns + accumulator % tick_ns;
+            }
+        }
+
+        std::uint64_t pendingTicks() const noexcept
+        {
+            return tick_ns ? accumulator / tick_ns : 0;
+        }
+
+        //when the next whole tick is due on SDL's clock, as of the last beginFrame
+        Uint64 nextTickAt() const noexcept
+        {
+            return accumulator >= tick_ns ? last : last + (tick_ns - accumulator);
+        }
+
+        //takes up to max whole ticks off the backlog, returns how many
+        std::uint64_t takeTicks(std::uint64_t max) noexcept
+        {
+            std::uint64_t ticks = std::min(max, pendingTicks());
+            accumulator -= ticks * tick_ns;
+            return ticks;
+        }
+
+        //how far into the next tick we are, in [0, 1) once the backlog is drained
+        float interpolation() const noexcept
+        {
+            if(tick_ns == 0)
+                return 0.0f;
+            return std::min(static_cast<float>(accumulator) / static_cast<float>(tick_ns), 1.0f);
+        }
+
+        std::uint64_t getDroppedTicks() const noexcept
+        {
+            return dropped_ticks;
+        }
+
+        //sleeps then spins until the next frame deadline; a late frame moves the deadline instead of
+        //making later frames short to catch up
+        void waitForNextFrame() noexcept
+        {
+            if(vsync)
+                return;
+            next_frame += frame_ns;
+            Uint64 now = SDL_GetTicksNS();
+            if(now >= next_frame)
+            {
+                next_frame = now;
+                return;
+            }
+            if(next_frame - now > spin_ns)
+            {
+                Uint64 wake_at = next_frame - spin_ns;
+                SDL_DelayNS(wake_at - now);
+                Uint64 woke = SDL_GetTicksNS();
+                //a longer overshoot is covered from the next frame on, a shorter one lets the margin shrink slowly
+                Uint64 margin = std::min((woke > wake_at ? woke - wake_at : 0) + FRAME_SPIN_MIN_NS, FRAME_SPIN_NS);
+                spin_ns = margin >= spin_ns ? margin : spin_ns - (spin_ns - margin) / 16;
+            }
+            while(SDL_GetTicksNS() < next_frame)
+            {}
+        }
+
+        //how long the last waits spun before their deadline
+        Uint64 getSpinNs() const noexcept
+        {
+            return spin_ns;
+        }
+
+        Uint64 getMeanFrameNs() const noexcept
+        {
+            if(interval_count == 0)
+                return 0;
+            Uint64 sum = 0;
+            for(size_t i=0; i<interval_count; i++)
+                sum += intervals[i];
+            return sum / interval_count;
+        }
+
+        //99th percentile of how far frame intervals stray from their mean over the last FRAME_HISTORY frames
+        Uint64 getJitterNs() const
+        {
+            if(interval_count == 0)
+                return 0;
+            Uint64 mean = getMeanFrameNs();
+            std::array<Uint64, FRAME_HISTORY> deviations;
+            for(size_t i=0; i<interval_count; i++)
+                deviations[i] = intervals[i] > mean ? intervals[i] - mean : mean - intervals[i];
+            size_t rank = (interval_count * 99) / 100;
+            std::nth_element(deviations.begin(), deviations.begin() + rank, deviations.begin() + interval_count);
+            return deviations[rank];
+        }
+};
+
+#endif
@@ -6,34 +6,70 @@
 #include "text_screen.h"
 #include "icon_screen.h"
 #include "ui_screen.h"
-#include "resources.h"
-#include "player.h"
+#include "sim_thread.h"
+#include "texture_manager.h"
+#include "asset_loader.h"
+#ifdef SKILLQUEST_HOT_RELOAD
+#include "hot_reload.h"
+#endif
+#include "text_cache.h"
 
+//the render thread: owns SDL, turns input into commands for the simulation thread and draws its snapshots
 class Game
 {
     SDL_Window *window = nullptr;
     SDL_Renderer *renderer = nullptr;
     TTF_Font *font = nullptr;
-    int fps = 60;
-    int frame_time = 1000/fps;
+    AssetLoader assets;
+    TextureManager texture_manager;
+    bool sprites_ready = false;
+    //what the screens draw, the ids in snapshots are ids of this table
+    std::shared_ptr<const Content> content = Content::defaults();
+#ifdef SKILLQUEST_HOT_RELOAD
+    HotReloader hot_reloader;
+    std::vector<ReloadedSprite> reloaded_sprites;
+    std::unique_ptr<Content> reloaded_content;
+    //reloaded content sent to the simulation thread, drawn from the first snapshot in its ids
+    std::shared_ptr<const Content> next_content;
+    std::uint64_t content_command = 0;
+#endif
+#ifdef SKILLQUEST_PROFILE
+    bool first_frame_noted = false;
+#endif
+    TextCache text_cache;
+    FrameScheduler scheduler = FrameScheduler(FRAME_NS);
     GameState game_state = GameState::MAIN;
     Menu main_menu = Menu({"New Game", "Load Game", "Quit"}, MAIN_MENU_BOX_WIDTH, MAIN_MENU_BOX_HEIGHT);
     Menu pause_menu =  Menu({"Continue", "Save Game", "Quit to Main Menu"}, PAUSE_MENU_BOX_WIDTH, PAUSE_MENU_BOX_HEIGHT);
     Menu save_menu = Menu({"Slot 1", "Slot 2", "Slot 3"}, SAVE_MENU_BOX_WIDTH, SAVE_MENU_BOX_HEIGHT);
+    Menu load_menu = Menu({"Slot 1", "Slot 2", "Slot 3", "Autosave"}, LOAD_MENU_BOX_WIDTH, LOAD_MENU_BOX_HEIGHT);
     GameScreen game_screen = GameScreen(GS_X, GS_Y, GS_W, GS_H);
     TextScreen text_screen = TextScreen(TS_X, TS_Y, TS_W, TS_H);
     IconScreen icons_screen = IconScreen(IS_X, IS_Y, IS_W, IS_H);
     UIScreen ui_screen = UIScreen(UIS_X, UIS_Y, UIS_W, UIS_H);
-    Player player = Player();
+    SimThread sim;
+    //a new game or load the menus wait for, 0 if none
+    std::uint64_t awaited_command = 0;
+    float wheel_notches = 0.0f;
+    //the right or middle button went down over the world and is still held
+    bool dragging_world = false;
 
     public:
         Game(){}
 
         void handleInput()
         {
+            PROFILE_ZONE("Game::handleInput");
             SDL_Event event;
             while(SDL_PollEvent(&event))
             {
+                if(event.type == SDL_EVENT_QUIT)
+                    game_state = GameState::QUIT;
+                else if(event.type == SDL_EVENT_RENDER_TARGETS_RESET || event.type == SDL_EVENT_RENDER_DEVICE_RESET)
+                    markScreensDirty();
+                //menus ignore keys while a game is being created or loaded
+                if(awaited_command != 0)
+                    continue;
                 switch(game_state)
                 {
                     case GameState::MAIN:
@@ -55,14 +91,10 @@ class Game
                                 case SDLK_RETURN:
                                 {
                                     std::string_view main_menu_item_name = main_menu.currentItem();
-                                    if(main_menu_item_name == "New Game" || main_menu_item_name == "Load Game")
-                                    {
-                                        game_state = GameState::RUNNING;
-                                        if (main_menu_item_name == "New Game")
-                                            newGame();
-                                        else
-                                            loadGame();
-                                    }
+                                    if(main_menu_item_name == "New Game")
+                                        awaited_command = sim.send({SimCommandType::NEW_GAME, 0});
+                                    else if(main_menu_item_name == "Load Game")
+                                        game_state = GameState::LOAD;
                                     else
                                         game_state = GameState::QUIT;
                                     break;
@@ -91,16 +123,19 @@ class Game
                                 {
                                     std::string_view pause_menu_item_name = pause_menu.currentItem();
                                     if(pause_menu_item_name == "Continue")
-                                        game_state = GameState::RUNNING;
+                                        resume();
                                     else if(pause_menu_item_name == "Save Game")
                                         game_state = GameState::SAVE;
                                     else
+                                    {
+                                        sim.send({SimCommandType::END_GAME, 0});
                                         game_state = GameState::MAIN;
+                                    }
                                     break;
                                 }
                                 case SDLK_ESCAPE:
                                 {
-                                    game_state = GameState::RUNNING;
+                                    resume();
                                     break;
                                 }
                             }
@@ -125,8 +160,8 @@ class Game
                                 }
                                 case SDLK_RETURN:
                                 {
-                                    saveGame();
-                                    game_state = GameState::RUNNING;
+                                    sim.send({SimCommandType::SAVE_GAME, save_menu.currentIndex()});
+                                    resume();
                                     break;
                                 }
                                 case SDLK_ESCAPE:
@@ -138,58 +173,118 @@ class Game
                         }
                         break;
                     }
+                    case GameState::LOAD:
+                    {
+                        if(event.type == SDL_EVENT_KEY_DOWN && !event.key.repeat)
+                        {
+                            switch(event.key.key)
+                            {
+                                case SDLK_UP:
+                                {
+                                    load_menu.moveUp();
+                                    break;
+                                }
+                                case SDLK_DOWN:
+                                {
+                                    load_menu.moveDown();
+                                    break;
+                                }
+                                case SDLK_RETURN:
+                                {
+                                    awaited_command = sim.send({SimCommandType::LOAD_GAME, load_menu.currentIndex()});
+                                    break;
+                                }
+                                case SDLK_ESCAPE:
+                                {
+                                    game_state = GameState::MAIN;
+                                    break;
+                                }
+                            }
+                        }
+                        break;
+                    }
                     case GameState::RUNNING:
                     {
                         if(event.type == SDL_EVENT_MOUSE_BUTTON_DOWN)
                         {
                             if(event.button.button == SDL_BUTTON_LEFT)
                             {
-                                if(event.button.x < game_screen.getWidth() && event.button.y < game_screen.getHeight())
-                                {
-                                    int res = game_screen.handleMouseClick(event.button.x, event.button.y);
-                                    switch(res)
-                                    {
-                                        case -1:
-                                        break;
-                                        case 0:
-                                        game_screen.setPlayerTarget(COPPER);
-                                        break;
-                                        case 1:
-                                        game_screen.setPlayerTarget(TIN);
-                                        break;
-                                        case 2:
-                                        game_screen.setPlayerTarget(IRON);
-                                        break;
-                                        case 3:
-                                        game_screen.setPlayerTarget(GOLD);
-                                        break;
-
-                                    }
-                                    switch(res)
-                                    {
-                                        case -1:
-                                        break;
-                                        case 0 ... 3:
-                                        ui_screen.setState(UIState::INVENTORY);
-                                        player.startAction(MINING);
-                                        text_screen.startedMining(game_screen.getPlayerTarget()->name_str, font);
-                                        break;
-                                    }
-                                }
+                                std::optional<ResourceId> res = game_screen.selectNode(event.button.x, event.button.y);
+                                if(res)
+                                    sim.send({SimCommandType::START_MINING, static_cast<size_t>(*res)});
+                            }
+                            else if(event.button.button == SDL_BUTTON_RIGHT || event.button.button == SDL_BUTTON_MIDDLE)
+                                dragging_world = game_screen.contains(event.button.x, event.button.y);
+                        }
+                        else if(event.type == SDL_EVENT_MOUSE_BUTTON_UP)
+                        {
+                            if(event.button.button == SDL_BUTTON_RIGHT || event.button.button == SDL_BUTTON_MIDDLE)
+                                dragging_world = false;
+                        }
+                        else if(event.type == SDL_EVENT_MOUSE_MOTION)
+                        {
+                            if(dragging_world)
+                                game_screen.pan(-event.motion.xrel, -event.motion.yrel);
+                            game_screen.hover(event.motion.x, event.motion.y);
+                            ui_screen.hover(event.motion.x, event.motion.y);
+                        }
+                        else if(event.type == SDL_EVENT_MOUSE_WHEEL)
+                        {
+                            float wheel = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.y : event.wheel.y;
+                            if(game_screen.contains(event.wheel.mouse_x, event.wheel.mouse_y))
+                                game_screen.zoomAt(event.wheel.mouse_x, event.wheel.mouse_y, wheel);
+                            else if(text_screen.contains(event.wheel.mouse_x, event.wheel.mouse_y))
+                            {
+                                //touchpads send fractions of a notch, whole notches scroll
+                                wheel_notches += wheel;
+                                int notches = static_cast<int>(wheel_notches);
+                                wheel_notches -= static_cast<float>(notches);
+                                text_screen.scrollBy(notches * SCROLL_LINES_PER_NOTCH);
                             }
-
                         }
                         else if(event.type == SDL_EVENT_KEY_DOWN)
                         {
+                            if(event.key.key == SDLK_PAGEUP)
+                                text_screen.scrollPage(1);
+                            else if(event.key.key == SDLK_PAGEDOWN)
+                                text_screen.scrollPage(-1);
+                            else if(event.key.key == SDLK_LEFT)
+                                game_screen.pan(-CAMERA_KEY_PAN, 0.0f);
+                            else if(event.key.key == SDLK_RIGHT)
+                                game_screen.pan(CAMERA_KEY_PAN, 0.0f);
+                            else if(event.key.key == SDLK_UP)
+                                game_screen.pan(0.0f, -CAMERA_KEY_PAN);
+                            else if(event.key.key == SDLK_DOWN)
+                                game_screen.pan(0.0f, CAMERA_KEY_PAN);
                             if(!event.key.repeat)
                             {
                                 switch(event.key.key)
                                 {
+                                    case SDLK_HOME:
+                                    {
+                                        game_screen.centreOnSpawn();
+                                        break;
+                                    }
                                     case SDLK_ESCAPE:
                                     {
+                                        dragging_world = false;
+                                        sim.send({SimCommandType::PAUSE, 0});
                                         game_state = GameState::PAUSE;
                                         break;
                                     }
+#ifdef SKILLQUEST_PROFILE
+                                    case SDLK_F3:
+                                    {
+                                        icons_screen.toggleProfile();
+                                        break;
+                                    }
+                                    case SDLK_F4:
+                                    {
+                                        if(!Profiler::instance().exportChromeTrace(PROFILE_TRACE_PATH))
+                                            std::cerr<<"Failed to write "<<PROFILE_TRACE_PATH<<"\n";
+                                        break;
+                                    }
+#endif
                                     default:
                                     {
                                         break;
@@ -199,87 +294,168 @@ class Game
                         }
                         break;
                     }
+                    default:
+                        break;
                 }
-                if(event.type == SDL_EVENT_QUIT)
-                    game_state = GameState::QUIT;
             }
         }
 
-        void newGame() noexcept
+        void markScreensDirty() noexcept
         {
-            SDL_RenderClear(renderer);
-            player.reset();
-            game_screen.stopExtraction();
-            ui_screen.setState(UIState::NONE);
-            text_screen.clearTextBuffer();
-            text_screen.pushTextToTextBuffer({"Welcome", "to", "SkillQuest!"}, {WHITE, WHITE, WHITE}, font);
+            game_screen.markDirty();
+            text_screen.markDirty();
+            icons_screen.markDirty();
+            ui_screen.markDirty();
         }
 
-        void saveGame() const
+        void releaseScreenCaches() noexcept
         {
+            game_screen.releaseCache();
+            text_screen.releaseCache();
+            icons_screen.releaseCache();
+            ui_screen.releaseCache();
+        }
 
+        void resume()
+        {
+            sim.send({SimCommandType::RESUME, 0});
+            game_state = GameState::RUNNING;
         }
 
-        void loadGame()
+        //takes the latest snapshot and brings the screens up to date with it
+        void updateFromSnapshot()
         {
+            PROFILE_ZONE("Game::updateFromSnapshot");
+            sim.acquire();
+            const FrameSnapshot& snapshot = sim.snapshot();
+            if(awaited_command != 0 && snapshot.handled_commands >= awaited_command)
+            {
+                //a load that failed leaves the load menu open
+                if(snapshot.in_game)
+                    game_state = GameState::RUNNING;
+                awaited_command = 0;
+            }
+#ifdef SKILLQUEST_HOT_RELOAD
+            if(content_command != 0 && snapshot.handled_commands >= content_command)
+            {
+                IdMap ids = next_content->mapFrom(*content);
+                content = std::move(next_content);
+                content_command = 0;
+                game_screen.remapContent(*content, ids);
+                ui_screen.markDirty();
+            }
+#endif
+            if(snapshot.in_game)
+                game_screen.setWorldSeed(snapshot.world_seed, *content);
+            text_screen.update(snapshot.log, text_cache, *content);
+            ui_screen.setState(snapshot.show_inventory ? UIState::INVENTORY : UIState::NONE);
+        }
 
+        //CONTENT_PATH, or the built in content if it is missing or has errors, shared with the simulation thread
+        void loadContent()
+        {
+            std::unique_ptr<Content> loaded = Content::load(CONTENT_PATH);
+            if(!loaded)
+            {
+                std::cerr<<"Using the built in content\n";
+                loaded = Content::builtIn();
+            }
+            loaded->assignSprites();
+            content = std::move(loaded);
+            game_screen.setContent(*content);
+            sim.setContent(content);
         }
 
-        void updateState()
+        //builds the atlas once the sprites are loaded; the menus are shown meanwhile, a game waits for them
+        bool updateAssets()
         {
-            switch(player.getAction())
+            if(sprites_ready || (!assets.ready() && game_state != GameState::RUNNING))
+                return true;
+            PROFILE_ZONE("Game::updateAssets");
+            assets.wait();
+            sprites_ready = true;
+            bool built = texture_manager.buildAtlas(renderer, assets.getSurfaces());
+            assets.releaseSurfaces();
+            if(!built)
             {
-                case IDLE:
-                {
-                    break;
-                }
-                case MINING:
-                {
-                    if(game_screen.getPlayerTarget())
-                    {
-                        auto drop = game_screen.extractResource(player);
-                        if(drop.empty() && player.isInventoryFull())
-                        {
-                            text_screen.inventoryFull(font);
-                            game_screen.stopExtraction();
-                            player.stopAction();
-                            return;
-                        }
-                        for(size_t i=0; i<drop.size(); i++)
-                            text_screen.mineSuccess(drop[i].obj_name_str, drop[i].rarity_color, font);
-                    }
-                    break;
-                }
+                std::cerr<<"Failed to build sprite atlas: "<<SDL_GetError()<<"\n";
+                return false;
+            }
+#ifdef SKILLQUEST_PROFILE
+            icons_screen.noteSpritesReady(assets.getLoadNs(), assets.getFromBundle(), assets.getDecoded());
+#endif
+            return true;
+        }
+
+#ifdef SKILLQUEST_HOT_RELOAD
+        //swaps in whatever the hot reloader finished since the last frame
+        void applyReloads()
+        {
+            if(!sprites_ready || !hot_reloader.take(reloaded_sprites, reloaded_content))
+                return;
+            PROFILE_ZONE("Game::applyReloads");
+            for(ReloadedSprite& sprite : reloaded_sprites)
+            {
+                if(!texture_manager.replaceSprite(renderer, register_sprite(sprite.path), sprite.surface))
+                    std::cerr<<"Failed to reload sprite "<<sprite.path<<": "<<SDL_GetError()<<"\n";
+                SDL_DestroySurface(sprite.surface);
+            }
+            reloaded_sprites.clear();
+            if(reloaded_content)
+            {
+                reloaded_content->assignSprites();
+                for(size_t i=0; i<reloaded_content->objectCount(); i++)
+                    if(!texture_manager.hasSprite(reloaded_content->sprite(static_cast<ObjectId>(i))))
+                        hot_reloader.requestSprite(ASSET_SPRITE_PATH_OBJECTS + std::string(reloaded_content->path(static_cast<ObjectId>(i))));
+                for(size_t i=0; i<reloaded_content->resourceCount(); i++)
+                    if(!texture_manager.hasSprite(reloaded_content->sprite(static_cast<ResourceId>(i))))
+                        hot_reloader.requestSprite(ASSET_SPRITE_PATH_RESOURCES + std::string(reloaded_content->path(static_cast<ResourceId>(i))));
+                next_content = std::move(reloaded_content);
+                content_command = sim.setContent(next_content);
             }
+            game_screen.markDirty();
+            ui_screen.markDirty();
         }
+#endif
 
         void renderFrame()
         {
+            PROFILE_ZONE("Game::renderFrame");
             SDL_SetRenderDrawColor(renderer, BLACK.r, BLACK.g, BLACK.b, BLACK.a);
             SDL_RenderClear(renderer);
             switch(game_state)
             {
                 case GameState::MAIN:
                 {
-                    main_menu.renderMenu(renderer, font);
+                    main_menu.renderMenu(renderer, text_cache);
                     break;
                 }
                 case GameState::PAUSE:
                 {
-                    pause_menu.renderMenu(renderer, font);
+                    pause_menu.renderMenu(renderer, text_cache);
                     break;
                 }
                 case GameState::SAVE:
                 {
-                    save_menu.renderMenu(renderer, font);
+                    save_menu.renderMenu(renderer, text_cache);
+                    break;
+                }
+                case GameState::LOAD:
+                {
+                    load_menu.renderMenu(renderer, text_cache);
                     break;
                 }
                 case GameState::RUNNING:
                 {
-                    game_screen.render(renderer);
-                    text_screen.render(renderer, font);
+                    const FrameSnapshot& snapshot = sim.snapshot();
+                    game_screen.render(renderer, texture_manager, *content);
+                    if(snapshot.action == MINING && snapshot.target)
+                        game_screen.renderTickProgress(renderer, *snapshot.target, snapshot.tickProgress(SDL_GetTicksNS()));
+                    game_screen.renderHover(renderer);
+                    text_screen.render(renderer, text_cache);
                     icons_screen.render(renderer);
-                    ui_screen.render(renderer, player);
+                    ui_screen.render(renderer, snapshot.inventory, texture_manager, *content);
+                    ui_screen.renderHover(renderer, snapshot.inventory);
                     break;
                 }
                 default:
@@ -322,47 +498,79 @@ class Game
                 return 4;
             }
 
-            font = TTF_OpenFont(FONT_PATH, FONT_SIZE);
+            //the content's sprites come first in the registry, then the loader adds whatever else it finds
+            loadContent();
+            //sprites decode on worker threads from here on, the first frames only need the font
+            assets.start();
+#ifdef SKILLQUEST_HOT_RELOAD
+            hot_reloader.start();
+#endif
+            font = assets.openFont(FONT_PATH, FONT_SIZE);
             if (!font) 
             {
                 std::cerr << "Failed to open font: " << SDL_GetError() << "\n";
+                assets.wait();
+                assets.releaseSurfaces();
                 TTF_Quit();
                 SDL_DestroyRenderer(renderer);
                 SDL_DestroyWindow(window);
                 SDL_Quit();
                 return 5;
             }
+            text_cache.bind(renderer, font);
 
-            Uint64 last = SDL_GetTicks();
-            Uint64 accumulator = 0;
+            scheduler.setVsync(FRAME_VSYNC && SDL_SetRenderVSync(renderer, 1));
+            scheduler.start();
+#ifdef SKILLQUEST_PROFILE
+            icons_screen.bindPacing(scheduler);
+#endif
+            sim.start();
 
+            int exit_code = 0;
             while(game_state != GameState::QUIT)
             {
-                Uint64 current = SDL_GetTicks();
-                Uint64 delta = current - last;
-                last = current;
-                accumulator += delta;
+                scheduler.beginFrame();
 
                 handleInput();
-                while(game_state == GameState::RUNNING && accumulator >= TICK)
+                updateFromSnapshot();
+                if(!updateAssets())
                 {
-                    updateState();
-                    accumulator -= TICK;
+                    exit_code = 6;
+                    break;
                 }
-
+#ifdef SKILLQUEST_HOT_RELOAD
+                applyReloads();
+#endif
                 renderFrame();
-
-                Uint64 frame_time_elapsed = SDL_GetTicks() - current;
-                if(frame_time_elapsed < frame_time)
-                    SDL_Delay(frame_time - frame_time_elapsed);
+#ifdef SKILLQUEST_PROFILE
+                if(!first_frame_noted)
+                {
+                    icons_screen.noteFirstFrame(SDL_GetTicksNS());
+                    first_frame_noted = true;
+                }
+#endif
+                {
+                    PROFILE_ZONE("FrameScheduler::wait");
+                    scheduler.waitForNextFrame();
+                }
+                PROFILE_FRAME();
             }
 
+            sim.stop();
+#ifdef SKILLQUEST_HOT_RELOAD
+            hot_reloader.stop();
+#endif
+            assets.wait();
+            assets.releaseSurfaces();
+            releaseScreenCaches();
+            texture_manager.destroy();
+            text_cache.clear();
             TTF_CloseFont(font);
             TTF_Quit();
             SDL_DestroyRenderer(renderer);
             SDL_DestroyWindow(window);
             SDL_Quit();
-            return 0;
+            return exit_code;
         }
 };
 
@@ -0,0 +1,120 @@
+#ifndef GAME_DATA_H
+#define GAME_DATA_H
+
+//game rules shared by the simulation and the SDL frontend, must not depend on SDL
+
+#include <iostream>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+//assets
+const std::string ASSET_SPRITE_PATH_OBJECTS = "assets/sprites/objects/";
+const std::string ASSET_SPRITE_PATH_RESOURCES = "assets/sprites/resources/";
+const std::string ASSET_DATA_PATH = "assets/data/";
+
+//saves
+const std::string SAVE_DIRECTORY = "saves/";
+constexpr size_t SAVE_SLOTS = 3;
+//the autosave file comes after the manual slots in the load menu
+constexpr size_t AUTOSAVE_SLOT = SAVE_SLOTS;
+constexpr std::uint64_t AUTOSAVE_INTERVAL_TICKS = 100;
+
+//time constants
+constexpr std::uint64_t TICK = 600;
+//backlogs at least this long (e.g. after sitting in the pause menu) are resolved in one go instead of tick by tick
+constexpr std::uint64_t FAST_FORWARD_MIN_TICKS = 100;
+
+//INVENTORY
+constexpr size_t INVENTORY_SIZE = 50;
+
+//most objects a single resource can drop
+constexpr size_t MAX_RESOURCE_DROPS = 32;
+
+using SpriteID = size_t;
+//drawn as nothing, for content whose sprite was never registered
+constexpr SpriteID NO_SPRITE = static_cast<SpriteID>(-1);
+
+enum class PlayerState : int
+{
+    IDLE,
+    MINING
+};
+
+//dense ids into the content tables (see content.h), an id is the entry's index in every column
+//the highest value is never an id, saves and journals use it for empty slots and no target
+enum class ObjectId : std::uint16_t {};
+enum class ResourceId : std::uint16_t {};
+constexpr std::uint16_t NO_CONTENT_ID = 0xFFFF;
+//most objects, and most resources, the content can define
+constexpr size_t MAX_CONTENT_IDS = NO_CONTENT_ID;
+
+enum class Rarity
+{
+    ALWAYS,
+    COMMON,
+    UNCOMMON,
+    RARE,
+    VERY_RARE
+};
+constexpr size_t RARITY_COUNT = static_cast<size_t>(Rarity::VERY_RARE) + 1;
+
+using enum PlayerState;
+using enum Rarity;
+
+constexpr std::string_view rarity_to_string(Rarity rarity)
+{
+    switch(rarity)
+    {
+        case ALWAYS: return "always";
+        case COMMON: return "common";
+        case UNCOMMON: return "uncommon";
+        case RARE: return "rare";
+        case VERY_RARE: return "very rare";
+        default: return "";
+    }
+}
+
+//total exp needed for each level, starting at level 1
+constexpr std::array<int, 11> LEVEL_EXP =
+{
+    0, 83, 174, 276, 388, 512, 650, 801, 969, 1154, 1358
+};
+
+consteval bool exp_curve_is_monotonic()
+{
+    for(size_t i=1; i<LEVEL_EXP.size(); i++)
+        if(LEVEL_EXP[i] <= LEVEL_EXP[i-1])
+            return false;
+    return true;
+}
+static_assert(exp_curve_is_monotonic(), "LEVEL_EXP must strictly increase");
+
+constexpr int level_exp_mapping(int level)
+{
+    if(level < 1 || level > static_cast<int>(LEVEL_EXP.size()))
+        return 10000000;
+    return LEVEL_EXP[level - 1];
+}
+
+constexpr Rarity drop_rate_to_rarity(int drop_rate)
+{
+    if(drop_rate > 500)
+        return VERY_RARE;
+    else if(drop_rate > 125)
+        return RARE;
+    else if(drop_rate > 40)
+        return UNCOMMON;
+    else if(drop_rate > 1)
+        return COMMON;
+    else
+        return ALWAYS;
+}
+
+#endif
\ No newline at end of file
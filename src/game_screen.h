@@ -2,184 +2,298 @@
 #define GAME_SCREEN_H
 
 #include "screen.h"
-#include "resources.h"
-#include "player.h"
-#include "random.h"
+#include "content.h"
+#include "texture_manager.h"
+#include "grid_mesh.h"
+#include "world_map.h"
 
 enum class GameScreenState
 {
     RESOURCES
 };
 
+//what the screen shows of the world: x and y are the world pixel at the screen's top left, a world pixel is
+//zoom screen pixels
+struct Camera
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float zoom = 1.0f;
+};
+
+//a chunk's boxes and sprites in world pixels, built once and kept while the chunk is in view
+struct ChunkMesh
+{
+    std::uint64_t revision = 0;
+    std::uint64_t sprite_generation = 0;
+    GridMesh boxes;
+    GridMesh sprites;
+    //sprites the atlas does not hold, drawn one by one
+    std::vector<std::pair<SpriteID, SDL_FRect>> loose;
+};
+
 class GameScreen : public Screen
 {
-    const Resource *player_resource_target = nullptr;
-    std::vector<std::array<float, 4>> grid_hlines_params;
-    std::vector<std::array<float, 4>> grid_vlines_params;
-    std::array<std::array<std::array<float, 2>, GS_cellsX>, GS_cellsY> resource_box_positions;
+    WorldMap world;
+    Camera camera;
+    //meshes of the chunks drawn last, by chunk index; chunks leaving the view drop theirs
+    std::unordered_map<size_t, ChunkMesh> meshes;
+    std::vector<SDL_Vertex> moved_vertices;
+    std::optional<TileCoord> hovered_tile;
+    //the node last clicked, its box shows the tick progress
+    std::optional<TileCoord> selected_tile;
     GameScreenState state = GameScreenState::RESOURCES;
-    const std::array<Resource, 4> game_resources = 
+
+    static constexpr float CHUNK_WIDTH = CHUNK_SIZE * TILE_STEP_X;
+    static constexpr float CHUNK_HEIGHT = CHUNK_SIZE * TILE_STEP_Y;
+
+    SDL_FRect tileBox(TileCoord tile) const noexcept
+    {
+        return {getX() + (tile.x * TILE_STEP_X + GRID_LINE_WIDTH - camera.x) * camera.zoom,
+            getY() + (tile.y * TILE_STEP_Y + GRID_LINE_WIDTH - camera.y) * camera.zoom,
+            GRID_BOX_WIDTH * camera.zoom, GRID_BOX_HEIGHT * camera.zoom};
+    }
+
+    //the world is drawn inside the screen only, partly visible boxes included
+    void clip(SDL_Renderer *renderer) const
     {
-        Resource(COPPER, "copper.png", {object_list.at(COPPER_ORE)}, {5}),
-        Resource(TIN, "tin.png", {object_list.at(TIN_ORE)}, {5}),
-        Resource(IRON, "iron.png", {object_list.at(IRON_ORE)}, {5}),
-        Resource(GOLD, "gold.png", {object_list.at(GOLD_ORE)}, {5})
-    };
+        SDL_Rect rect = {static_cast<int>(getX()), static_cast<int>(getY()), static_cast<int>(getWidth()), static_cast<int>(getHeight())};
+        SDL_SetRenderClipRect(renderer, &rect);
+    }
+
+    //keeps the middle of the view inside the world
+    void clampCamera() noexcept
+    {
+        float half_w = getWidth() / camera.zoom / 2.0f;
+        float half_h = getHeight() / camera.zoom / 2.0f;
+        camera.x = std::clamp(camera.x, -half_w, world.tilesX() * TILE_STEP_X - half_w);
+        camera.y = std::clamp(camera.y, -half_h, world.tilesY() * TILE_STEP_Y - half_h);
+    }
+
+    void buildMesh(ChunkMesh& mesh, size_t cx, size_t cy, const TextureManager& textures, const Content& content)
+    {
+        const WorldChunk& chunk = world.chunk(cx, cy);
+        mesh.revision = chunk.revision;
+        mesh.sprite_generation = textures.getGeneration();
+        mesh.boxes.clear();
+        mesh.sprites.clear();
+        mesh.loose.clear();
+        float x1 = cx * CHUNK_WIDTH;
+        float y1 = cy * CHUNK_HEIGHT;
+        //one quad of line color under the chunk, the boxes leave the lines showing; it reaches over the next
+        //chunk's first lines so the world's far edges get theirs too
+        mesh.boxes.addQuad({x1, y1, CHUNK_WIDTH + GRID_LINE_WIDTH, CHUNK_HEIGHT + GRID_LINE_WIDTH}, GRID_LINE_COLOR);
+        for(size_t i=0; i<CHUNK_TILES; i++)
+        {
+            SDL_FRect box = {x1 + (i % CHUNK_SIZE) * TILE_STEP_X + GRID_LINE_WIDTH, y1 + (i / CHUNK_SIZE) * TILE_STEP_Y + GRID_LINE_WIDTH,
+                static_cast<float>(GRID_BOX_WIDTH), static_cast<float>(GRID_BOX_HEIGHT)};
+            mesh.boxes.addQuad(box, GRID_BOX_COLOR);
+            if(chunk.tiles[i] == NO_CONTENT_ID)
+                continue;
+            ResourceId resource = static_cast<ResourceId>(chunk.tiles[i]);
+            if(!content.has(resource))
+                continue;
+            if(!textures.addSprite(mesh.sprites, content.sprite(resource), box))
+                mesh.loose.push_back({content.sprite(resource), box});
+        }
+    }
 
     public:
         GameScreen(float x, float y, float w, float h) : Screen(x, y, w, h)
         {
-            float stepX = GRID_LINE_WIDTH + GRID_BOX_WIDTH;
-            float stepY = GRID_LINE_WIDTH + GRID_BOX_HEIGHT;
-
-            float total_grid_width = GS_cellsX * stepX + GRID_LINE_WIDTH;
-            float total_grid_height = GS_cellsY * stepY + GRID_LINE_WIDTH;
-
-            float x1 = getX() + (getWidth() - total_grid_width)/2.0f;
-            float y1 = getY() + (getHeight() - total_grid_height)/2.0f;
-
-            for(size_t i=0; i<=GS_cellsY; i++)
-                for(size_t j=0; j<GS_cellsX; j++)
-                    for(size_t k=0; k<GRID_LINE_WIDTH; k++)
-                        if(j != GS_cellsX - 1)
-                            grid_hlines_params.push_back({x1 + j*stepX, y1 + i*stepY + k, x1 + (j+1)*stepX - 1.0f, y1 + i*stepY + k});
-                        else
-                            grid_hlines_params.push_back({x1 + j*stepX, y1 + i*stepY +k, x1 + (j+1)*stepX + GRID_LINE_WIDTH - 1.0f, y1 + i*stepY + k});
-                
-            for(size_t i=0; i<=GS_cellsX; i++)
-                for(size_t j=0; j<GS_cellsY; j++)
-                    for(size_t k=0; k<GRID_LINE_WIDTH; k++)
-                        if(j != GS_cellsY - 1)
-                            grid_vlines_params.push_back({x1 + i*stepX + k, y1 + j*stepY, x1 + i*stepX +k, y1 + (j+1)*stepY - 1.0f});
-                        else
-                            grid_vlines_params.push_back({x1 + i*stepX + k, y1 + j*stepY, x1 + i*stepX + k, y1 + (j+1)*stepY + GRID_LINE_WIDTH - 1.0f});
-
-            for(size_t i=0; i<GS_cellsY; i++)
-                for(size_t j=0; j<GS_cellsX; j++)
-                {
-                    resource_box_positions[i][j][0] = x1 + j*stepX + GRID_LINE_WIDTH;
-                    resource_box_positions[i][j][1] = y1 + i*stepY + GRID_LINE_WIDTH;
-                }
+            centreOnSpawn();
         }
 
-        void render(SDL_Renderer *renderer) const
+        //a new table: the world is generated again for it
+        void setContent(const Content& content)
         {
-            renderBox(renderer);
-            switch(state)
-            {
-                case GameScreenState::RESOURCES:
-                {
-                    renderResources(renderer);
-                    break;
-                }
-                default:
-                    break;
-            }
+            world.reset(world.getSeed(), content.resourceCount());
+            meshes.clear();
+            selected_tile.reset();
+            markDirty();
         }
 
-        void renderResources(SDL_Renderer *renderer) const
+        //the content was reloaded while playing, ids maps the old table's ids to those of content
+        void remapContent(const Content& content, const IdMap& ids)
         {
-            renderGrid(renderer);
-            for(size_t i=0; i<game_resources.size(); i++)
-            {
-                size_t x = i % GS_cellsX;
-                size_t y = i / GS_cellsX;
-                SDL_FRect dst = {resource_box_positions[y][x][0], resource_box_positions[y][x][1], static_cast<float>(GRID_BOX_WIDTH), static_cast<float>(GRID_BOX_HEIGHT)};
-                SDL_Texture* texture = IMG_LoadTexture(renderer, game_resources[i].path.c_str());
-                SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
-                SDL_RenderTexture(renderer, texture, nullptr, &dst);
-                SDL_DestroyTexture(texture);
-            }
+            world.remap(ids, content.resourceCount());
+            markDirty();
         }
 
-        void renderGrid(SDL_Renderer *renderer) const
+        //each game has its own world, generated from the game's seed
+        void setWorldSeed(std::uint64_t seed, const Content& content)
         {
-            SDL_SetRenderDrawColor(renderer, GRID_LINE_COLOR.r, GRID_LINE_COLOR.g, GRID_LINE_COLOR.b, GRID_LINE_COLOR.a);
-            for(const auto params : grid_hlines_params)
-                SDL_RenderLine(renderer, params[0], params[1], params[2], params[3]);
-            for(const auto params : grid_vlines_params)
-                SDL_RenderLine(renderer, params[0], params[1], params[2], params[3]);
-            SDL_SetRenderDrawColor(renderer, GRID_BOX_COLOR.r, GRID_BOX_COLOR.g, GRID_BOX_COLOR.b, GRID_BOX_COLOR.a);
-            for(size_t y=0; y<resource_box_positions.size(); y++)
-                for(size_t x=0; x<resource_box_positions[y].size(); x++)
-                {
-                    SDL_FRect dst = {resource_box_positions[y][x][0], resource_box_positions[y][x][1], static_cast<float>(GRID_BOX_WIDTH), static_cast<float>(GRID_BOX_HEIGHT)};
-                    SDL_RenderFillRect(renderer, &dst);
-                }
+            if(seed == world.getSeed())
+                return;
+            world.reset(seed, content.resourceCount());
+            meshes.clear();
+            selected_tile.reset();
+            centreOnSpawn();
         }
 
-        bool setPlayerTarget(ResourceName item)
+        //the tile whose box holds the screen point, none on a line or outside the world
+        std::optional<TileCoord> tileAt(float x, float y) const noexcept
         {
-            for(const auto& it : game_resources)
-                if(it.name == item)
-                {
-                    player_resource_target = &it;
-                    return true;
-                }
-            player_resource_target = nullptr;
-            return false;
+            if(!contains(x, y))
+                return std::nullopt;
+            float wx = camera.x + (x - getX()) / camera.zoom;
+            float wy = camera.y + (y - getY()) / camera.zoom;
+            if(wx < 0.0f || wy < 0.0f)
+                return std::nullopt;
+            size_t tx = static_cast<size_t>(wx / TILE_STEP_X);
+            size_t ty = static_cast<size_t>(wy / TILE_STEP_Y);
+            if(tx >= world.tilesX() || ty >= world.tilesY())
+                return std::nullopt;
+            if(wx - tx * TILE_STEP_X < GRID_LINE_WIDTH || wy - ty * TILE_STEP_Y < GRID_LINE_WIDTH)
+                return std::nullopt;
+            return TileCoord{tx, ty};
         }
 
-        const Resource* getPlayerTarget() const noexcept
+        //the resource node under the point, which becomes the one the tick progress is shown on
+        std::optional<ResourceId> selectNode(float x, float y)
         {
-            return player_resource_target;
+            std::optional<TileCoord> tile = tileAt(x, y);
+            if(!tile)
+                return std::nullopt;
+            std::optional<ResourceId> resource = world.resourceAt(tile->x, tile->y);
+            if(resource)
+                selected_tile = tile;
+            return resource;
         }
 
-        std::vector<DropResult> extractResource(Player& player) 
-        //Extracts resource and adds it to inventory, returns name to updateState for verbose
+        void hover(float x, float y) noexcept
         {
-            if(player_resource_target == nullptr)
-                return {};
-            //handle drop_rate = 0 case
-            std::vector<DropResult> res = {};
-            res.reserve(player_resource_target->len);
-            for (size_t i=0; i<player_resource_target->len; i++)
-            {
-                if(random_int(0, player_resource_target->drop_rates[i] - 1) == 0)
-                        if(player.addItem(player_resource_target->objects[i]))
-                            res.emplace_back(player_resource_target->objects[i].name, player_resource_target->rarities[i], player_resource_target->rarity_colors[i]);
-            }
-            if(!res.empty())
-                return res;
-            return {};
+            hovered_tile = tileAt(x, y);
         }
 
-        void stopExtraction()
+        //by screen pixels
+        void pan(float dx, float dy) noexcept
         {
-            player_resource_target = nullptr;
+            camera.x += dx / camera.zoom;
+            camera.y += dy / camera.zoom;
+            clampCamera();
+            markDirty();
         }
 
-        int handleMouseClick(int x, int y)
+        //zooms by notches of ZOOM_PER_NOTCH, the world point under (x, y) stays where it is
+        void zoomAt(float x, float y, float notches) noexcept
         {
-            float stepX = GRID_LINE_WIDTH + GRID_BOX_WIDTH;
-            float stepY = GRID_LINE_WIDTH + GRID_BOX_HEIGHT;
-
-            float total_grid_width = GS_cellsX * stepX + GRID_LINE_WIDTH;
-            float total_grid_height = GS_cellsY * stepY + GRID_LINE_WIDTH;
-
-            float x1 = getX() + (getWidth() - total_grid_width)/2.0f;
-            float y1 = getY() + (getHeight() - total_grid_height)/2.0f;
+            float zoom = std::clamp(camera.zoom * std::pow(ZOOM_PER_NOTCH, notches), ZOOM_MIN, ZOOM_MAX);
+            if(zoom == camera.zoom)
+                return;
+            float wx = camera.x + (x - getX()) / camera.zoom;
+            float wy = camera.y + (y - getY()) / camera.zoom;
+            camera.zoom = zoom;
+            camera.x = wx - (x - getX()) / zoom;
+            camera.y = wy - (y - getY()) / zoom;
+            clampCamera();
+            markDirty();
+        }
 
-            float posx = x - x1;
-            float posy = y - y1;
+        //the spawn block in the middle of the view
+        void centreOnSpawn() noexcept
+        {
+            float block_w = (2 * SPAWN_ROW_NODES - 1) * TILE_STEP_X;
+            camera.x = world.spawnX() * TILE_STEP_X + block_w / 2.0f - getWidth() / camera.zoom / 2.0f;
+            camera.y = world.spawnY() * TILE_STEP_Y + TILE_STEP_Y / 2.0f - getHeight() / camera.zoom / 2.0f;
+            clampCamera();
+            markDirty();
+        }
 
-            if(posx < 0 || posy < 0)
-                return -1;
+        void render(SDL_Renderer *renderer, const TextureManager& textures, const Content& content)
+        {
+            PROFILE_ZONE("GameScreen::render");
+            if(beginCache(renderer))
+            {
+                switch(state)
+                {
+                    case GameScreenState::RESOURCES:
+                    {
+                        renderWorld(renderer, textures, content);
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                renderBox(renderer);
+                endCache(renderer);
+            }
+            blitCache(renderer);
+        }
 
-            float localX = fmod(posx, stepX);
-            float localY = fmod(posy, stepY);
+        //only the chunks in view, each with one draw call for its boxes and one for its sprites
+        void renderWorld(SDL_Renderer *renderer, const TextureManager& textures, const Content& content)
+        {
+            float view_w = getWidth() / camera.zoom;
+            float view_h = getHeight() / camera.zoom;
+            float right = camera.x + view_w;
+            float bottom = camera.y + view_h;
+            if(right <= 0.0f || bottom <= 0.0f)
+                return;
+            size_t cx0 = static_cast<size_t>(std::max(camera.x, 0.0f) / CHUNK_WIDTH);
+            size_t cy0 = static_cast<size_t>(std::max(camera.y, 0.0f) / CHUNK_HEIGHT);
+            size_t cx1 = std::min(static_cast<size_t>(right / CHUNK_WIDTH), world.chunksX() - 1);
+            size_t cy1 = std::min(static_cast<size_t>(bottom / CHUNK_HEIGHT), world.chunksY() - 1);
 
-            if (localX < GRID_LINE_WIDTH || localY < GRID_LINE_WIDTH)
-                return -1;
+            std::erase_if(meshes, [&](const auto& entry)
+            {
+                size_t cx = entry.first % world.chunksX();
+                size_t cy = entry.first / world.chunksX();
+                return cx < cx0 || cx > cx1 || cy < cy0 || cy > cy1;
+            });
 
-            x = static_cast<int>(posx / stepX);
-            y = static_cast<int>(posy / stepY);
+            clip(renderer);
+            float x = getX() - camera.x * camera.zoom;
+            float y = getY() - camera.y * camera.zoom;
+            for(size_t cy=cy0; cy<=cy1; cy++)
+                for(size_t cx=cx0; cx<=cx1; cx++)
+                {
+                    auto [it, added] = meshes.try_emplace(cy * world.chunksX() + cx);
+                    ChunkMesh& mesh = it->second;
+                    if(added || mesh.revision != world.chunk(cx, cy).revision || mesh.sprite_generation != textures.getGeneration())
+                        buildMesh(mesh, cx, cy, textures, content);
+                    mesh.boxes.render(renderer, nullptr, x, y, camera.zoom, moved_vertices);
+                    mesh.sprites.render(renderer, textures.getAtlas(), x, y, camera.zoom, moved_vertices);
+                    for(const auto& [sprite, box] : mesh.loose)
+                    {
+                        SDL_FRect dst = {x + box.x * camera.zoom, y + box.y * camera.zoom, box.w * camera.zoom, box.h * camera.zoom};
+                        textures.renderSprite(renderer, sprite, &dst);
+                    }
+                }
+            SDL_SetRenderClipRect(renderer, nullptr);
+        }
 
-            if((x >= GS_cellsX) || (y >= GS_cellsY))
-                return -1;
+        //drawn over the cached screen every frame: a bar along the bottom of the mined node's box, fraction
+        //is how far the current tick is, interpolated between ticks by the frame scheduler
+        //the node is the one clicked, or the resource's node in the spawn block if the game was loaded mining
+        void renderTickProgress(SDL_Renderer *renderer, ResourceId resource, float fraction)
+        {
+            std::optional<TileCoord> tile = selected_tile;
+            if(!tile || world.resourceAt(tile->x, tile->y) != resource)
+                tile = world.spawnTile(resource);
+            if(!tile)
+                return;
+            SDL_FRect box = tileBox(*tile);
+            SDL_FRect bar = {box.x, box.y + box.h - PROGRESS_BAR_HEIGHT, box.w * fraction, PROGRESS_BAR_HEIGHT};
+            clip(renderer);
+            SDL_SetRenderDrawColor(renderer, PROGRESS_BAR_COLOR.r, PROGRESS_BAR_COLOR.g, PROGRESS_BAR_COLOR.b, PROGRESS_BAR_COLOR.a);
+            SDL_RenderFillRect(renderer, &bar);
+            SDL_SetRenderClipRect(renderer, nullptr);
+            PROFILE_COUNT(DRAW_CALLS, 1);
+        }
 
-            return y * GS_cellsX + x;
+        //outline around the node under the mouse, drawn every frame over the cached screen
+        void renderHover(SDL_Renderer *renderer)
+        {
+            if(!hovered_tile || !world.resourceAt(hovered_tile->x, hovered_tile->y))
+                return;
+            SDL_FRect box = tileBox(*hovered_tile);
+            clip(renderer);
+            SDL_SetRenderDrawColor(renderer, HOVER_BOX_COLOR.r, HOVER_BOX_COLOR.g, HOVER_BOX_COLOR.b, HOVER_BOX_COLOR.a);
+            SDL_RenderRect(renderer, &box);
+            SDL_SetRenderClipRect(renderer, nullptr);
+            PROFILE_COUNT(DRAW_CALLS, 1);
         }
 };
 
-#endif
\ No newline at end of file
+#endif
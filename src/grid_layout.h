@@ -0,0 +1,70 @@
+#ifndef GRID_LAYOUT_H
+#define GRID_LAYOUT_H
+
+#include "constants.h"
+
+//where the boxes of a grid are: GRID_BOX_WIDTH x GRID_BOX_HEIGHT boxes with GRID_LINE_WIDTH lines around them,
+//cells_x per row, numbered row by row; computed once, a point maps to its cell with two divisions
+class GridLayout
+{
+    static constexpr float STEP_X = GRID_LINE_WIDTH + GRID_BOX_WIDTH;
+    static constexpr float STEP_Y = GRID_LINE_WIDTH + GRID_BOX_HEIGHT;
+
+    //top left of the outer lines
+    float x1 = 0.0f;
+    float y1 = 0.0f;
+    size_t cells_x = 1;
+    size_t num_cells = 0;
+
+    public:
+        GridLayout(){}
+
+        //a cells_x x cells_y grid centred in the rect, of which the first num_cells are used
+        GridLayout(float x, float y, float w, float h, size_t cells_x, size_t cells_y, size_t num_cells) :
+            cells_x(std::max<size_t>(cells_x, 1)), num_cells(std::min(num_cells, this->cells_x * cells_y))
+        {
+            x1 = x + (w - (this->cells_x * STEP_X + GRID_LINE_WIDTH))/2.0f;
+            y1 = y + (h - (cells_y * STEP_Y + GRID_LINE_WIDTH))/2.0f;
+        }
+
+        float originX() const noexcept { return x1; }
+        float originY() const noexcept { return y1; }
+        size_t cellsX() const noexcept { return cells_x; }
+        size_t cellCount() const noexcept { return num_cells; }
+
+        SDL_FRect box(size_t cell) const noexcept
+        {
+            return {x1 + (cell % cells_x)*STEP_X + GRID_LINE_WIDTH, y1 + (cell / cells_x)*STEP_Y + GRID_LINE_WIDTH,
+                static_cast<float>(GRID_BOX_WIDTH), static_cast<float>(GRID_BOX_HEIGHT)};
+        }
+
+        //the cell whose box holds the point, none on a line or outside the grid
+        std::optional<size_t> cellAt(float x, float y) const noexcept
+        {
+            float posx = x - x1;
+            float posy = y - y1;
+            if(posx < 0.0f || posy < 0.0f)
+                return std::nullopt;
+            size_t column = static_cast<size_t>(posx / STEP_X);
+            size_t row = static_cast<size_t>(posy / STEP_Y);
+            if(column >= cells_x)
+                return std::nullopt;
+            if(posx - column*STEP_X < GRID_LINE_WIDTH || posy - row*STEP_Y < GRID_LINE_WIDTH)
+                return std::nullopt;
+            size_t cell = row * cells_x + column;
+            if(cell >= num_cells)
+                return std::nullopt;
+            return cell;
+        }
+
+        //outline around the box of cell, drawn every frame over a cached screen
+        void renderOutline(SDL_Renderer *renderer, size_t cell) const
+        {
+            SDL_FRect outline = box(cell);
+            SDL_SetRenderDrawColor(renderer, HOVER_BOX_COLOR.r, HOVER_BOX_COLOR.g, HOVER_BOX_COLOR.b, HOVER_BOX_COLOR.a);
+            SDL_RenderRect(renderer, &outline);
+            PROFILE_COUNT(DRAW_CALLS, 1);
+        }
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef GRID_MESH_H
+#define GRID_MESH_H
+
+#include "constants.h"
+
+//grid lines and cells as colored quads in one vertex/index buffer, drawn with a single SDL_RenderGeometry call
+//quads with texture coordinates batch sprites of one texture the same way
+class GridMesh
+{
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    public:
+        void clear() noexcept
+        {
+            vertices.clear();
+            indices.clear();
+        }
+
+        bool empty() const noexcept
+        {
+            return indices.empty();
+        }
+
+        void addQuad(const SDL_FRect& rect, SDL_Color color)
+        {
+            addQuad(rect, color, {0.0f, 0.0f, 0.0f, 0.0f});
+        }
+
+        //uv is the part of the texture drawn over the quad, in [0, 1]
+        void addQuad(const SDL_FRect& rect, SDL_Color color, const SDL_FRect& uv)
+        {
+            SDL_FColor fcolor = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back({{rect.x, rect.y}, fcolor, {uv.x, uv.y}});
+            vertices.push_back({{rect.x + rect.w, rect.y}, fcolor, {uv.x + uv.w, uv.y}});
+            vertices.push_back({{rect.x + rect.w, rect.y + rect.h}, fcolor, {uv.x + uv.w, uv.y + uv.h}});
+            vertices.push_back({{rect.x, rect.y + rect.h}, fcolor, {uv.x, uv.y + uv.h}});
+            indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+        }
+
+        //num_cells cells laid out row by row, cells_x per row, the last row may be partial
+        void addGrid(float x1, float y1, size_t cells_x, size_t num_cells)
+        {
+            const float stepX = GRID_LINE_WIDTH + GRID_BOX_WIDTH;
+            const float stepY = GRID_LINE_WIDTH + GRID_BOX_HEIGHT;
+            const size_t full_rows = num_cells / cells_x;
+            const size_t remainder = num_cells % cells_x;
+
+            vertices.reserve(vertices.size() + 4 * (num_cells + cells_x + full_rows + 3));
+            indices.reserve(indices.size() + 6 * (num_cells + cells_x + full_rows + 3));
+
+            for(size_t i=0; i<=full_rows; i++)
+                addQuad({x1, y1 + i*stepY, cells_x*stepX + GRID_LINE_WIDTH, static_cast<float>(GRID_LINE_WIDTH)}, GRID_LINE_COLOR);
+            if(remainder > 0)
+                addQuad({x1, y1 + (full_rows+1)*stepY, remainder*stepX + GRID_LINE_WIDTH, static_cast<float>(GRID_LINE_WIDTH)}, GRID_LINE_COLOR);
+
+            for(size_t i=0; i<=cells_x; i++)
+            {
+                size_t rows = (remainder > 0 && i <= remainder) ? full_rows + 1 : full_rows;
+                addQuad({x1 + i*stepX, y1, static_cast<float>(GRID_LINE_WIDTH), rows*stepY + GRID_LINE_WIDTH}, GRID_LINE_COLOR);
+            }
+
+            for(size_t i=0; i<num_cells; i++)
+                addQuad({x1 + (i % cells_x)*stepX + GRID_LINE_WIDTH, y1 + (i / cells_x)*stepY + GRID_LINE_WIDTH,
+                    static_cast<float>(GRID_BOX_WIDTH), static_cast<float>(GRID_BOX_HEIGHT)}, GRID_BOX_COLOR);
+        }
+
+        void render(SDL_Renderer *renderer, SDL_Texture *texture = nullptr) const
+        {
+            if(indices.empty())
+                return;
+            SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+            PROFILE_COUNT(DRAW_CALLS, 1);
+        }
+
+        //drawn at position * scale + (x, y), the mesh itself is left as built; moved holds the moved vertices
+        //and is kept by the caller so drawing allocates nothing once it is large enough
+        void render(SDL_Renderer *renderer, SDL_Texture *texture, float x, float y, float scale, std::vector<SDL_Vertex>& moved) const
+        {
+            if(indices.empty())
+                return;
+            moved.resize(vertices.size());
+            for(size_t i=0; i<vertices.size(); i++)
+            {
+                moved[i] = vertices[i];
+                moved[i].position = {vertices[i].position.x * scale + x, vertices[i].position.y * scale + y};
+            }
+            SDL_RenderGeometry(renderer, texture, moved.data(), static_cast<int>(moved.size()), indices.data(), static_cast<int>(indices.size()));
+            PROFILE_COUNT(DRAW_CALLS, 1);
+        }
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+//reloads sprites and the content table while the game runs, compiled in with SKILLQUEST_HOT_RELOAD
+//a FileWatcher thread decodes the PNGs or parses the content that changed, off the render thread, and keeps
+//the results until Game takes them at the start of a frame; nothing here ever waits on that thread, a frame that
+//finds it busy simply takes the results on the next one
+
+#include "constants.h"
+#include "file_watcher.h"
+#include "content.h"
+
+struct ReloadedSprite
+{
+    std::string path;
+    SDL_Surface *surface;
+};
+
+class HotReloader
+{
+    FileWatcher watcher;
+    std::mutex ready_mutex;
+    //decoded or parsed, waiting for the render thread
+    std::vector<ReloadedSprite> sprites;
+    std::unique_ptr<Content> content;
+
+    static bool is_png(std::string_view path) noexcept
+    {
+        return path.size() > 4 && path.substr(path.size() - 4) == ".png";
+    }
+
+    //watcher thread
+    void reload(const std::vector<std::string>& paths)
+    {
+        for(const std::string& path : paths)
+        {
+            if(is_png(path))
+            {
+                SDL_Surface *surface = IMG_Load(path.c_str());
+                if(!surface)
+                {
+                    //the file may still be half written, the write that completes it is another change
+                    std::cerr<<"Failed to reload sprite "<<path<<": "<<SDL_GetError()<<"\n";
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(ready_mutex);
+                sprites.push_back({path, surface});
+            }
+            else if(path == CONTENT_PATH)
+            {
+                std::unique_ptr<Content> loaded = Content::load(path);
+                if(!loaded)
+                    continue;
+                std::lock_guard<std::mutex> lock(ready_mutex);
+                content = std::move(loaded);
+            }
+        }
+    }
+
+    public:
+        HotReloader(){}
+
+        HotReloader(const HotReloader&) = delete;
+        HotReloader& operator=(const HotReloader&) = delete;
+
+        ~HotReloader()
+        {
+            stop();
+        }
+
+        //the content at startup is loaded by Game, this only picks up later edits
+        void start()
+        {
+            watcher.watch(ASSET_SPRITE_PATH_OBJECTS);
+            watcher.watch(ASSET_SPRITE_PATH_RESOURCES);
+            watcher.watch(ASSET_DATA_PATH);
+            watcher.start([this](const std::vector<std::string>& paths){ reload(paths); });
+        }
+
+        void stop()
+        {
+            watcher.stop();
+            std::lock_guard<std::mutex> lock(ready_mutex);
+            for(ReloadedSprite& sprite : sprites)
+                SDL_DestroySurface(sprite.surface);
+            sprites.clear();
+            content.reset();
+        }
+
+        //decodes a sprite that content refers to but that was never loaded
+        void requestSprite(const std::string& path)
+        {
+            watcher.touch(path);
+        }
+
+        //render thread: moves out what is ready, the caller owns the surfaces; false if there was nothing or
+        //the watcher thread was busy handing over
+        bool take(std::vector<ReloadedSprite>& ready_sprites, std::unique_ptr<Content>& ready_content)
+        {
+            std::unique_lock<std::mutex> lock(ready_mutex, std::try_to_lock);
+            if(!lock.owns_lock() || (sprites.empty() && !content))
+                return false;
+            ready_sprites.swap(sprites);
+            ready_content = std::move(content);
+            return true;
+        }
+};
+
+#endif
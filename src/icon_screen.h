@@ -3,16 +3,166 @@
 
 #include "screen.h"
 
+#ifdef SKILLQUEST_PROFILE
+#include "frame_scheduler.h"
+
+//frames between refreshes of the overlay's zone table, sorting a few thousand zones every frame would show up in it
+constexpr size_t PROFILE_SUMMARY_FRAMES = 30;
+constexpr float PROFILE_GRAPH_HEIGHT = 60.0f;
+constexpr float PROFILE_LINE_HEIGHT = 10.0f;
+constexpr std::uint64_t PROFILE_GRAPH_MAX_NS = 2 * FRAME_NS;
+#endif
+
 class IconScreen : public Screen
 {
+#ifdef SKILLQUEST_PROFILE
+    bool show_profile = false;
+    //the render loop's, for the interval and jitter line
+    const FrameScheduler *pacing = nullptr;
+    //startup, 0 until known; SDL's clock starts at SDL_Init
+    std::uint64_t first_frame_ns = 0;
+    std::uint64_t sprites_ready_ns = 0;
+    size_t sprites_from_bundle = 0;
+    size_t sprites_decoded = 0;
+    size_t frames_since_summary = PROFILE_SUMMARY_FRAMES;
+    std::vector<ZoneSummary> zones;
+    std::vector<ProfileEvent> scratch;
+    std::vector<std::string> lines;
+
+    void refreshProfileLines()
+    {
+        const Profiler& profiler = Profiler::instance();
+        size_t frames = profiler.getFrameCount();
+        lines.clear();
+        if(frames == 0)
+            return;
+        std::vector<std::uint64_t> durations(frames);
+        std::uint64_t total = 0;
+        std::array<std::uint64_t, PROFILE_COUNTER_COUNT> counters{};
+        for(size_t i=0; i<frames; i++)
+        {
+            durations[i] = profiler.getFrame(i).duration_ns;
+            total += durations[i];
+            for(size_t c=0; c<PROFILE_COUNTER_COUNT; c++)
+                counters[c] += profiler.getFrame(i).counters[c];
+        }
+        size_t rank = std::min(frames - 1, (frames * 99) / 100);
+        std::nth_element(durations.begin(), durations.begin() + rank, durations.end());
+
+        char line[96];
+        std::snprintf(line, sizeof(line), "frame %.2f ms  p99 %.2f ms", total / 1e6 / frames, durations[rank] / 1e6);
+        lines.emplace_back(line);
+        if(pacing)
+        {
+            std::snprintf(line, sizeof(line), "interval %.2f ms  jitter %.3f ms  spin %.2f ms", pacing->getMeanFrameNs() / 1e6,
+                pacing->getJitterNs() / 1e6, pacing->getSpinNs() / 1e6);
+            lines.emplace_back(line);
+        }
+        if(sprites_ready_ns != 0)
+        {
+            std::snprintf(line, sizeof(line), "first frame %.1f ms  sprites %.1f ms", first_frame_ns / 1e6, sprites_ready_ns / 1e6);
+            lines.emplace_back(line);
+            std::snprintf(line, sizeof(line), "sprites %zu packed  %zu decoded", sprites_from_bundle, sprites_decoded);
+        }
+        else
+            std::snprintf(line, sizeof(line), "first frame %.1f ms  sprites loading", first_frame_ns / 1e6);
+        lines.emplace_back(line);
+        std::snprintf(line, sizeof(line), "draws %.1f  uploads %.1f per frame",
+            static_cast<double>(counters[static_cast<size_t>(ProfileCounter::DRAW_CALLS)]) / frames,
+            static_cast<double>(counters[static_cast<size_t>(ProfileCounter::TEXTURE_UPLOADS)]) / frames);
+        lines.emplace_back(line);
+        lines.emplace_back("zone                    mean us  p99 us  /frame");
+        profiler.summarize(zones, scratch);
+        for(const ZoneSummary& zone : zones)
+        {
+            std::snprintf(line, sizeof(line), "%-24.24s%7.1f %7.1f %6.2f", zone.name, zone.mean_ns / 1e3, zone.p99_ns / 1e3,
+                static_cast<double>(zone.count) / frames);
+            lines.emplace_back(line);
+        }
+    }
+#endif
+
     public:
         IconScreen(float x, float y, float w, float h) : Screen(x, y, w, h)
         {}
 
-        void render(SDL_Renderer *renderer) const
+        void render(SDL_Renderer *renderer)
         {
-            renderBox(renderer);
+            PROFILE_ZONE("IconScreen::render");
+            if(beginCache(renderer))
+            {
+                renderBox(renderer);
+                endCache(renderer);
+            }
+            blitCache(renderer);
+#ifdef SKILLQUEST_PROFILE
+            if(show_profile)
+                renderProfile(renderer);
+#endif
+        }
+
+#ifdef SKILLQUEST_PROFILE
+        void toggleProfile() noexcept
+        {
+            show_profile = !show_profile;
+            frames_since_summary = PROFILE_SUMMARY_FRAMES;
+        }
+
+        void bindPacing(const FrameScheduler& scheduler) noexcept
+        {
+            pacing = &scheduler;
+        }
+
+        void noteFirstFrame(std::uint64_t ns) noexcept
+        {
+            first_frame_ns = ns;
+        }
+
+        void noteSpritesReady(std::uint64_t load_ns, size_t from_bundle, size_t decoded) noexcept
+        {
+            sprites_ready_ns = load_ns;
+            sprites_from_bundle = from_bundle;
+            sprites_decoded = decoded;
+        }
+
+        //frame time graph (newest on the right, the line marks the frame budget) and the zone table,
+        //drawn over the cached box every frame with SDL's debug font so it never creates textures
+        void renderProfile(SDL_Renderer *renderer)
+        {
+            if(++frames_since_summary >= PROFILE_SUMMARY_FRAMES)
+            {
+                refreshProfileLines();
+                frames_since_summary = 0;
+            }
+            const Profiler& profiler = Profiler::instance();
+            float left = getX() + 4.0f;
+            float bottom = getY() + 4.0f + PROFILE_GRAPH_HEIGHT;
+            size_t bars = std::min(profiler.getFrameCount(), static_cast<size_t>((getWidth() - 8.0f) / 2.0f));
+            for(size_t age=0; age<bars; age++)
+            {
+                std::uint64_t duration = std::min(profiler.getFrame(age).duration_ns, PROFILE_GRAPH_MAX_NS);
+                float h = PROFILE_GRAPH_HEIGHT * static_cast<float>(duration) / static_cast<float>(PROFILE_GRAPH_MAX_NS);
+                SDL_FRect bar = {left + (bars - 1 - age) * 2.0f, bottom - h, 2.0f, h};
+                if(profiler.getFrame(age).duration_ns > FRAME_NS + FRAME_NS / 10)
+                    SDL_SetRenderDrawColor(renderer, RED.r, RED.g, RED.b, RED.a);
+                else
+                    SDL_SetRenderDrawColor(renderer, GRID_BOX_COLOR.r, GRID_BOX_COLOR.g, GRID_BOX_COLOR.b, GRID_BOX_COLOR.a);
+                SDL_RenderFillRect(renderer, &bar);
+            }
+            float budget_y = bottom - PROFILE_GRAPH_HEIGHT * static_cast<float>(FRAME_NS) / static_cast<float>(PROFILE_GRAPH_MAX_NS);
+            SDL_SetRenderDrawColor(renderer, WHITE.r, WHITE.g, WHITE.b, WHITE.a);
+            SDL_RenderLine(renderer, left, budget_y, getX() + getWidth() - 4.0f, budget_y);
+
+            float y = bottom + 4.0f;
+            for(const std::string& line : lines)
+            {
+                if(y + PROFILE_LINE_HEIGHT > getY() + getHeight())
+                    break;
+                SDL_RenderDebugText(renderer, left, y, line.c_str());
+                y += PROFILE_LINE_HEIGHT;
+            }
         }
+#endif
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,202 @@
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+#include "game_data.h"
+#include <bit>
+
+//fixed capacity container of objects, slots are filled lowest index first
+//free slots are tracked in a bitmap with summary levels above it (one bit per word of the level below),
+//so finding the first free slot costs one word per level, which stays at 2-3 levels even for vault sized containers
+//slots holding the same object are chained together so counting, finding and removing an object never scans
+class Inventory
+{
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+    size_t capacity;
+    size_t occupancy = 0;
+    std::vector<ObjectId> slots;
+    std::vector<bool> occupied;
+    std::vector<size_t> next_same;
+    std::vector<size_t> prev_same;
+    //by ObjectId, grown to the highest id placed so far
+    std::vector<size_t> first_same;
+    std::vector<size_t> counts;
+    //free_levels[0] has a set bit per free slot, free_levels[k] a set bit per non zero word of free_levels[k-1]
+    std::vector<std::vector<std::uint64_t>> free_levels;
+
+    void markFree(size_t slot)
+    {
+        for(auto& level : free_levels)
+        {
+            std::uint64_t& word = level[slot / 64];
+            bool was_empty = (word == 0);
+            word |= std::uint64_t{1} << (slot % 64);
+            if(!was_empty)
+                return;
+            slot /= 64;
+        }
+    }
+
+    void markUsed(size_t slot)
+    {
+        for(auto& level : free_levels)
+        {
+            std::uint64_t& word = level[slot / 64];
+            word &= ~(std::uint64_t{1} << (slot % 64));
+            if(word != 0)
+                return;
+            slot /= 64;
+        }
+    }
+
+    size_t firstFree() const noexcept
+    {
+        if(free_levels.back()[0] == 0)
+            return NO_SLOT;
+        size_t index = 0;
+        for(size_t level = free_levels.size(); level-- > 0;)
+            index = index * 64 + static_cast<size_t>(std::countr_zero(free_levels[level][index]));
+        return index;
+    }
+
+    public:
+        explicit Inventory(size_t capacity) :
+        capacity(capacity),
+        slots(capacity, ObjectId{}),
+        occupied(capacity, false),
+        next_same(capacity, NO_SLOT),
+        prev_same(capacity, NO_SLOT)
+        {
+            size_t bits = capacity;
+            do
+            {
+                free_levels.emplace_back(std::max<size_t>((bits + 63) / 64, 1), 0);
+                bits = (bits + 63) / 64;
+            } while(bits > 1);
+            clear();
+        }
+
+        void clear() noexcept
+        {
+            for(auto& level : free_levels)
+                std::fill(level.begin(), level.end(), 0);
+            for(size_t i=0; i<capacity; i++)
+            {
+                occupied[i] = false;
+                markFree(i);
+            }
+            std::fill(first_same.begin(), first_same.end(), NO_SLOT);
+            std::fill(counts.begin(), counts.end(), 0);
+            occupancy = 0;
+        }
+
+        size_t size() const noexcept
+        {
+            return capacity;
+        }
+
+        size_t getOccupancy() const noexcept
+        {
+            return occupancy;
+        }
+
+        bool isFull() const noexcept
+        {
+            return occupancy == capacity;
+        }
+
+        std::optional<ObjectId> at(size_t slot) const noexcept
+        {
+            if(!occupied[slot])
+                return std::nullopt;
+            return slots[slot];
+        }
+
+        size_t count(ObjectId item) const noexcept
+        {
+            size_t id = static_cast<size_t>(item);
+            return id < counts.size() ? counts[id] : 0;
+        }
+
+        bool contains(ObjectId item) const noexcept
+        {
+            return count(item) > 0;
+        }
+
+        //returns the slot the item went into
+        std::optional<size_t> add(ObjectId item)
+        {
+            size_t slot = firstFree();
+            if(!place(slot, item))
+                return std::nullopt;
+            return slot;
+        }
+
+        //puts an item into a specific empty slot, used when restoring a saved layout
+        bool place(size_t slot, ObjectId item)
+        {
+            if(slot >= capacity || occupied[slot])
+                return false;
+            size_t id = static_cast<size_t>(item);
+            if(id >= counts.size())
+            {
+                first_same.resize(id + 1, NO_SLOT);
+                counts.resize(id + 1, 0);
+            }
+            slots[slot] = item;
+            occupied[slot] = true;
+            markUsed(slot);
+            prev_same[slot] = NO_SLOT;
+            next_same[slot] = first_same[id];
+            if(first_same[id] != NO_SLOT)
+                prev_same[first_same[id]] = slot;
+            first_same[id] = slot;
+            counts[id]++;
+            occupancy++;
+            return true;
+        }
+
+        bool removeAt(size_t slot)
+        {
+            if(slot >= capacity || !occupied[slot])
+                return false;
+            size_t id = static_cast<size_t>(slots[slot]);
+            if(prev_same[slot] != NO_SLOT)
+                next_same[prev_same[slot]] = next_same[slot];
+            else
+                first_same[id] = next_same[slot];
+            if(next_same[slot] != NO_SLOT)
+                prev_same[next_same[slot]] = prev_same[slot];
+            occupied[slot] = false;
+            markFree(slot);
+            counts[id]--;
+            occupancy--;
+            return true;
+        }
+
+        bool remove(ObjectId item)
+        {
+            size_t id = static_cast<size_t>(item);
+            size_t slot = id < first_same.size() ? first_same[id] : NO_SLOT;
+            if(slot == NO_SLOT)
+                return false;
+            return removeAt(slot);
+        }
+};
+
+//copy of an inventory's slots that another thread can read, revision tells copies of different contents apart
+struct InventoryView
+{
+    std::uint64_t revision = 0;
+    std::vector<std::optional<ObjectId>> slots;
+
+    void assign(const Inventory& inventory, std::uint64_t new_revision)
+    {
+        slots.resize(inventory.size());
+        for(size_t i=0; i<slots.size(); i++)
+            slots[i] = inventory.at(i);
+        revision = new_revision;
+    }
+};
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+//append only log of simulation state changes between two autosave checkpoints
+//file: JOURNAL_MAGIC, u16 version, u64 checkpoint id, then one frame per committed batch of records
+//frame: u32 payload size, u32 crc32 of the payload, payload = u64 commit time in ms since the epoch followed by records
+//record: u8 JournalOp and its operands, see Journal; objects and resources are ids of the KEYS section of the
+//snapshot the journal follows, version 1 wrote them and the action as one byte instead of two
+//a crash can leave a torn frame at the end, replay stops at the first frame whose size or crc does not check out
+
+#include "save_file.h"
+#include <chrono>
+
+constexpr std::array<char, 4> JOURNAL_MAGIC = {'S', 'Q', 'J', 'L'};
+constexpr std::uint16_t JOURNAL_VERSION = 2;
+constexpr std::uint16_t NO_TARGET = NO_CONTENT_ID;
+
+enum class JournalOp : std::uint8_t
+{
+    RESET,
+    ITEM_ADDED,
+    ACTION,
+    TARGET
+};
+
+struct JournalRecord
+{
+    JournalOp op;
+    std::uint16_t value; //object, action or resource, NO_TARGET for no target
+    std::uint32_t slot;
+};
+
+std::filesystem::path journal_path(std::uint64_t checkpoint_id)
+{
+    return SAVE_DIRECTORY + "journal_" + std::to_string(checkpoint_id) + ".sqj";
+}
+
+//checkpoint ids of the journal files in SAVE_DIRECTORY
+std::vector<std::uint64_t> journal_ids()
+{
+    std::vector<std::uint64_t> ids;
+    std::error_code ec;
+    for(const auto& entry : std::filesystem::directory_iterator(SAVE_DIRECTORY, ec))
+    {
+        std::string name = entry.path().filename().string();
+        if(!name.starts_with("journal_") || !name.ends_with(".sqj") || name.size() <= 12)
+            continue;
+        std::uint64_t id = 0;
+        bool numeric = true;
+        for(char c : std::string_view(name).substr(8, name.size() - 12))
+        {
+            numeric = numeric && c >= '0' && c <= '9';
+            id = id * 10 + static_cast<std::uint64_t>(c - '0');
+        }
+        if(numeric)
+            ids.push_back(id);
+    }
+    return ids;
+}
+
+//deletes the journals of checkpoints older than limit, they are covered by a snapshot on disk
+void remove_journals_before(std::uint64_t limit)
+{
+    std::error_code ec;
+    for(std::uint64_t id : journal_ids())
+        if(id < limit)
+            std::filesystem::remove(journal_path(id), ec);
+}
+
+class Journal
+{
+    std::FILE *file = nullptr;
+    std::uint64_t checkpoint_id = 0;
+    std::vector<std::uint8_t> frame;
+
+    void put(std::uint64_t value, size_t n)
+    {
+        for(size_t i=0; i<n; i++)
+            frame.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+
+    public:
+        Journal(){}
+
+        Journal(const Journal&) = delete;
+        Journal& operator=(const Journal&) = delete;
+
+        ~Journal()
+        {
+            close();
+        }
+
+        //starts the journal that follows the snapshot tagged with checkpoint_id
+        bool open(std::uint64_t checkpoint_id)
+        {
+            close();
+            std::error_code ec;
+            std::filesystem::create_directories(SAVE_DIRECTORY, ec);
+            file = std::fopen(journal_path(checkpoint_id).string().c_str(), "wb");
+            if(!file)
+                return false;
+            this->checkpoint_id = checkpoint_id;
+            frame.assign(JOURNAL_MAGIC.begin(), JOURNAL_MAGIC.end());
+            put(JOURNAL_VERSION, 2);
+            put(checkpoint_id, 8);
+            bool ok = std::fwrite(frame.data(), 1, frame.size(), file) == frame.size() && std::fflush(file) == 0;
+            frame.clear();
+            return ok;
+        }
+
+        void close() noexcept
+        {
+            if(file)
+                std::fclose(file);
+            file = nullptr;
+            frame.clear();
+        }
+
+        bool isOpen() const noexcept
+        {
+            return file != nullptr;
+        }
+
+        std::uint64_t getCheckpointId() const noexcept
+        {
+            return checkpoint_id;
+        }
+
+        void record(JournalOp op, std::uint16_t value = 0, std::uint32_t slot = 0)
+        {
+            if(!file)
+                return;
+            if(frame.empty())
+                put(0, 16);
+            put(static_cast<std::uint8_t>(op), 1);
+            switch(op)
+            {
+                case JournalOp::RESET:
+                    break;
+                case JournalOp::ITEM_ADDED:
+                    put(value, 2);
+                    put(slot, 4);
+                    break;
+                case JournalOp::ACTION:
+                case JournalOp::TARGET:
+                    put(value, 2);
+                    break;
+            }
+        }
+
+        //appends everything recorded since the last commit as one frame, nothing is written if nothing changed
+        //the data reaches the OS right away so a crash of the game loses nothing committed; fsync is left to the
+        //checkpoint snapshots, which bound what an OS crash can take
+        bool commit()
+        {
+            if(!file || frame.empty())
+                return true;
+            std::uint64_t now_ms = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            std::uint32_t payload_size = static_cast<std::uint32_t>(frame.size() - 8);
+            for(size_t i=0; i<8; i++)
+                frame[8 + i] = static_cast<std::uint8_t>(now_ms >> (8 * i));
+            std::uint32_t crc = crc32(frame.data() + 8, payload_size);
+            for(size_t i=0; i<4; i++)
+            {
+                frame[i] = static_cast<std::uint8_t>(payload_size >> (8 * i));
+                frame[4 + i] = static_cast<std::uint8_t>(crc >> (8 * i));
+            }
+            bool ok = std::fwrite(frame.data(), 1, frame.size(), file) == frame.size() && std::fflush(file) == 0;
+            frame.clear();
+            return ok;
+        }
+};
+
+//walks the intact frames of a journal file
+class JournalReader
+{
+    MappedFile file;
+    ByteReader frames;
+    ByteReader records;
+    std::uint16_t version = 0;
+    std::uint64_t checkpoint_id = 0;
+    std::uint64_t last_commit_ms = 0;
+
+    std::uint16_t getValue() noexcept
+    {
+        if(version >= 2)
+            return records.get16();
+        std::uint8_t value = records.get8();
+        return value == 0xFF ? NO_TARGET : value;
+    }
+
+    public:
+        bool open(const std::filesystem::path& path)
+        {
+            if(!file.open(path))
+                return false;
+            frames = ByteReader{file.getData(), file.getSize()};
+            std::string_view magic = frames.getBytes(JOURNAL_MAGIC.size());
+            version = frames.get16();
+            checkpoint_id = frames.get64();
+            records = ByteReader{};
+            return frames.ok && magic == std::string_view(JOURNAL_MAGIC.data(), JOURNAL_MAGIC.size()) && version <= JOURNAL_VERSION;
+        }
+
+        std::uint64_t getCheckpointId() const noexcept
+        {
+            return checkpoint_id;
+        }
+
+        std::uint64_t getLastCommitMs() const noexcept
+        {
+            return last_commit_ms;
+        }
+
+        bool next(JournalRecord& record)
+        {
+            while(!records.ok || records.pos == records.size)
+            {
+                if(!frames.ok || frames.pos == frames.size)
+                    return false;
+                std::uint32_t payload_size = frames.get32();
+                std::uint32_t crc = frames.get32();
+                std::string_view payload = frames.getBytes(payload_size);
+                if(!frames.ok || payload_size < 8 || crc != crc32(reinterpret_cast<const std::uint8_t*>(payload.data()), payload.size()))
+                {
+                    frames.ok = false;
+                    return false;
+                }
+                records = ByteReader{reinterpret_cast<const std::uint8_t*>(payload.data()), payload.size()};
+                last_commit_ms = records.get64();
+            }
+            record.op = static_cast<JournalOp>(records.get8());
+            record.value = 0;
+            record.slot = 0;
+            switch(record.op)
+            {
+                case JournalOp::RESET:
+                    break;
+                case JournalOp::ITEM_ADDED:
+                    record.value = getValue();
+                    record.slot = records.get32();
+                    break;
+                case JournalOp::ACTION:
+                case JournalOp::TARGET:
+                    record.value = getValue();
+                    break;
+                default:
+                    records.ok = false;
+            }
+            //a frame that passed its crc but does not parse was written by something else, stop trusting the file
+            if(!records.ok)
+            {
+                frames.ok = false;
+                return false;
+            }
+            return true;
+        }
+};
+
+#endif
@@ -2,11 +2,13 @@
 #define MENU_H
 
 #include "constants.h"
+#include "text_cache.h"
 
 class Menu
 {
     size_t index;
     const std::vector<std::string> items;
+    std::vector<std::string> selected_items;
     const size_t menu_size, menu_box_width, menu_box_height;
     const float menu_pos_x, menu_pos_y;
     const SDL_FRect menu_box;
@@ -21,13 +23,22 @@ class Menu
         menu_pos_x(static_cast<float>((SCREEN_WIDTH - menu_box_width) / 2)),
         menu_pos_y(static_cast<float>((SCREEN_HEIGHT - menu_box_height) / 2)),
         menu_box{menu_pos_x, menu_pos_y, static_cast<float>(menu_box_width), static_cast<float>(menu_box_height)}
-        {}
+        {
+            selected_items.reserve(menu_size);
+            for(const std::string& item : this->items)
+                selected_items.push_back("->" + item);
+        }
 
         std::string_view currentItem() const noexcept
         {
             return items[index];
         }
 
+        size_t currentIndex() const noexcept
+        {
+            return index;
+        }
+
         void moveUp() noexcept
         {
             if(index > 0)
@@ -40,22 +51,18 @@ class Menu
                 index++;
         }
 
-        void renderMenu(SDL_Renderer* renderer, TTF_Font* font) const
+        void renderMenu(SDL_Renderer* renderer, TextCache& text_cache) const
         {
+            PROFILE_ZONE("Menu::renderMenu");
             SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
             SDL_RenderFillRect(renderer, &menu_box);
+            PROFILE_COUNT(DRAW_CALLS, 1);
 
             for(size_t i=0; i<menu_size; i++)
             {
-                std::string text = (i == index) ? "->" + items[i] : items[i];
-                SDL_Surface* text_surface = TTF_RenderText_Blended(font, (text).c_str(), strlen(text.c_str()), WHITE);
-                SDL_Texture* text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-                SDL_DestroySurface(text_surface);
-                int w, h;
-                TTF_GetStringSize(font, text.c_str(), strlen(text.c_str()), &w, &h);
-                SDL_FRect dst {menu_box.x + (menu_box.w - w) / 2.0f, menu_box.y + FONT_SIZE * i, static_cast<float>(w), static_cast<float>(h)};
-                SDL_RenderTexture(renderer, text_texture, nullptr, &dst);
-                SDL_DestroyTexture(text_texture);
+                const std::string& text = (i == index) ? selected_items[i] : items[i];
+                int w = text_cache.get(text, WHITE).w;
+                text_cache.draw(text, WHITE, menu_box.x + (menu_box.w - w) / 2.0f, menu_box.y + FONT_SIZE * i);
             }
         }
 };
@@ -0,0 +1,217 @@
+#ifndef MESSAGE_LOG_H
+#define MESSAGE_LOG_H
+
+//the messages shown in the text screen, kept by the simulation thread as template ids and arguments in a
+//fixed ring of LOG_HISTORY entries; the words are only put together when the render thread lays them out,
+//see TextScreen::update, so logging a message is a few bytes and never allocates
+
+#include "constants.h"
+#include "content.h"
+
+//messages kept for scrollback
+constexpr size_t LOG_HISTORY = 4096;
+
+enum class MessageId : std::uint8_t
+{
+    WELCOME,
+    STARTED_MINING, //arg is the ResourceId
+    MINED, //arg is the ObjectId, rarity colors it
+    INVENTORY_FULL,
+    GAME_SAVED,
+    SAVING_FAILED,
+    RECOVERED,
+    COUNT
+};
+constexpr size_t MESSAGE_COUNT = static_cast<size_t>(MessageId::COUNT);
+
+struct LogMessage
+{
+    MessageId id;
+    std::uint16_t arg;
+    Rarity rarity;
+};
+
+//a word of a message template; RESOURCE and OBJECT words are the argument's name followed by text
+enum class TemplateWordKind : std::uint8_t
+{
+    TEXT,
+    RESOURCE,
+    OBJECT
+};
+
+struct TemplateWord
+{
+    TemplateWordKind kind;
+    std::string_view text;
+    SDL_Color color; //OBJECT words take the message's rarity color instead
+};
+
+constexpr size_t MAX_TEMPLATE_WORDS = 5;
+
+struct MessageTemplate
+{
+    std::array<TemplateWord, MAX_TEMPLATE_WORDS> words;
+    size_t len;
+};
+
+//indexed by MessageId
+constexpr std::array<MessageTemplate, MESSAGE_COUNT> MESSAGE_TEMPLATES =
+{{
+    {{{{TemplateWordKind::TEXT, "Welcome", WHITE}, {TemplateWordKind::TEXT, "to", WHITE}, {TemplateWordKind::TEXT, "SkillQuest!", WHITE}}}, 3},
+    {{{{TemplateWordKind::TEXT, "You", WHITE}, {TemplateWordKind::TEXT, "started", WHITE}, {TemplateWordKind::TEXT, "to", WHITE},
+        {TemplateWordKind::TEXT, "mine", WHITE}, {TemplateWordKind::RESOURCE, ".", WHITE}}}, 5},
+    {{{{TemplateWordKind::TEXT, "You", WHITE}, {TemplateWordKind::TEXT, "mined", WHITE}, {TemplateWordKind::TEXT, "a", WHITE},
+        {TemplateWordKind::OBJECT, ".", WHITE}}}, 4},
+    {{{{TemplateWordKind::TEXT, "Your", WHITE}, {TemplateWordKind::TEXT, "inventory", WHITE}, {TemplateWordKind::TEXT, "is", WHITE},
+        {TemplateWordKind::TEXT, "full!", WHITE}}}, 4},
+    {{{{TemplateWordKind::TEXT, "Game", WHITE}, {TemplateWordKind::TEXT, "saved.", WHITE}}}, 2},
+    {{{{TemplateWordKind::TEXT, "Saving", RED}, {TemplateWordKind::TEXT, "failed!", RED}}}, 2},
+    {{{{TemplateWordKind::TEXT, "Recovered", WHITE}, {TemplateWordKind::TEXT, "unsaved", WHITE}, {TemplateWordKind::TEXT, "progress.", WHITE}}}, 3}
+}};
+
+class MessageLog
+{
+    std::vector<LogMessage> ring = std::vector<LogMessage>(LOG_HISTORY);
+    //messages pushed since the last clear, the newest is at (total - 1) % LOG_HISTORY
+    std::uint64_t total = 0;
+    //bumped by every clear, so a copy can tell a cleared log from one that did not change
+    std::uint64_t generation = 0;
+
+    public:
+        MessageLog(){}
+
+        std::uint64_t getTotal() const noexcept
+        {
+            return total;
+        }
+
+        std::uint64_t getGeneration() const noexcept
+        {
+            return generation;
+        }
+
+        //messages still held, the oldest has number getTotal() - size()
+        size_t size() const noexcept
+        {
+            return static_cast<size_t>(std::min<std::uint64_t>(total, LOG_HISTORY));
+        }
+
+        //by number in [getTotal() - size(), getTotal())
+        const LogMessage& message(std::uint64_t number) const noexcept
+        {
+            return ring[number % LOG_HISTORY];
+        }
+
+        void clear() noexcept
+        {
+            total = 0;
+            generation++;
+        }
+
+        void push(MessageId id, std::uint16_t arg = 0, Rarity rarity = ALWAYS) noexcept
+        {
+            ring[total % LOG_HISTORY] = {id, arg, rarity};
+            total++;
+        }
+
+        void startedMining(ResourceId resource) noexcept
+        {
+            push(MessageId::STARTED_MINING, static_cast<std::uint16_t>(resource));
+        }
+
+        void mineSuccess(ObjectId object, Rarity rarity) noexcept
+        {
+            push(MessageId::MINED, static_cast<std::uint16_t>(object), rarity);
+        }
+
+        void inventoryFull() noexcept
+        {
+            push(MessageId::INVENTORY_FULL);
+        }
+
+        //brings this copy up to date with other, copying only the messages it has not seen
+        void copyFrom(const MessageLog& other) noexcept
+        {
+            if(generation != other.generation || total > other.total || other.total - total >= LOG_HISTORY)
+            {
+                ring = other.ring;
+                total = other.total;
+                generation = other.generation;
+                return;
+            }
+            for(; total < other.total; total++)
+                ring[total % LOG_HISTORY] = other.ring[total % LOG_HISTORY];
+        }
+
+        //the argument of a message that takes a resource or an object, mapped through ids; nullopt if its key is gone
+        static std::optional<std::uint16_t> map_arg(MessageId id, std::uint32_t arg, const IdMap& ids) noexcept
+        {
+            if(id == MessageId::STARTED_MINING)
+            {
+                std::optional<ResourceId> resource = ids.resource(arg);
+                return resource ? std::optional<std::uint16_t>(static_cast<std::uint16_t>(*resource)) : std::nullopt;
+            }
+            if(id == MessageId::MINED)
+            {
+                std::optional<ObjectId> object = ids.object(arg);
+                return object ? std::optional<std::uint16_t>(static_cast<std::uint16_t>(*object)) : std::nullopt;
+            }
+            return static_cast<std::uint16_t>(arg);
+        }
+
+        //moves the arguments to the ids of reloaded content, messages about what it no longer has are dropped
+        void remap(const IdMap& ids)
+        {
+            std::vector<LogMessage> kept;
+            kept.reserve(size());
+            for(std::uint64_t number = total - size(); number < total; number++)
+            {
+                const LogMessage& entry = message(number);
+                if(std::optional<std::uint16_t> arg = map_arg(entry.id, entry.arg, ids))
+                    kept.push_back({entry.id, *arg, entry.rarity});
+            }
+            clear();
+            for(const LogMessage& entry : kept)
+                push(entry.id, entry.arg, entry.rarity);
+        }
+
+        //messages section: the message count, then per message its id, u16 argument and rarity, oldest first;
+        //before save version 3 the argument was one byte
+        void writeSave(SaveWriter& writer) const
+        {
+            writer.beginSection(SAVE_TAG_MESSAGES);
+            writer.put32(static_cast<std::uint32_t>(size()));
+            for(std::uint64_t number = total - size(); number < total; number++)
+            {
+                const LogMessage& entry = message(number);
+                writer.put8(static_cast<std::uint8_t>(entry.id));
+                writer.put16(entry.arg);
+                writer.put8(static_cast<std::uint8_t>(entry.rarity));
+            }
+            writer.endSection();
+        }
+
+        //a missing or damaged section leaves the log empty, or with the messages before the damage; ids is
+        //Content::readKeys of the same save
+        void readSave(const SaveReader& reader, const IdMap& ids)
+        {
+            clear();
+            std::optional<ByteReader> section = reader.section(SAVE_TAG_MESSAGES);
+            if(!section)
+                return;
+            bool wide = reader.getVersion() >= 3;
+            std::uint32_t count = section->get32();
+            for(std::uint32_t i=0; i<count && section->ok; i++)
+            {
+                std::uint8_t id = section->get8();
+                std::uint32_t arg = wide ? section->get16() : section->get8();
+                std::uint8_t rarity = section->get8();
+                if(!section->ok || id >= MESSAGE_COUNT || rarity >= RARITY_COUNT)
+                    continue;
+                if(std::optional<std::uint16_t> mapped = map_arg(static_cast<MessageId>(id), arg, ids))
+                    push(static_cast<MessageId>(id), *mapped, static_cast<Rarity>(rarity));
+            }
+        }
+};
+
+#endif
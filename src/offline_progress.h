@@ -0,0 +1,64 @@
+#ifndef OFFLINE_PROGRESS_H
+#define OFFLINE_PROGRESS_H
+
+//resolves many mining ticks at once with the same statistics as calling Simulation::tick in a loop
+//the drop sampler jumps straight from one tick with drops to the next, so this only costs one step per
+//drop tick, which is bounded by the free inventory space and not by the number of ticks
+
+#include "content.h"
+#include "player.h"
+#include "random.h"
+
+struct OfflineProgress
+{
+    std::uint64_t ticks = 0; //ticks consumed, fewer than requested when mining stopped early
+    bool inventory_full = false; //mining stopped because the inventory filled up
+    std::vector<DropResult> drops; //in the order they would have been mined
+};
+
+OfflineProgress resolve_offline_ticks(const ResourceDrops& drops, const DropSampler& sampler, Player& player, std::uint64_t ticks, Rng& rng)
+{
+    OfflineProgress res;
+    if(ticks == 0)
+        return res;
+    //the first tick finds nothing to add and stops, same as tick()
+    if(player.isInventoryFull())
+    {
+        res.ticks = 1;
+        res.inventory_full = true;
+        return res;
+    }
+
+    std::uint64_t tick = 0;
+    while(true)
+    {
+        tick += sampler.ticksToNextDrop(rng, ticks - tick + 1);
+        if(tick > ticks)
+        {
+            res.ticks = ticks;
+            return res;
+        }
+
+        //objects drop in index order within a tick, matching extractResource
+        sampler.sampleDropTick(rng, [&](size_t i)
+        {
+            if(std::optional<size_t> slot = player.addItem(drops.objects[i]))
+                res.drops.push_back({drops.objects[i], drops.rarities[i], *slot});
+            return !player.isInventoryFull();
+        });
+        if(player.isInventoryFull())
+        {
+            //the rest of this tick's drops are lost and the following tick stops mining
+            if(tick == ticks)
+            {
+                res.ticks = ticks;
+                return res;
+            }
+            res.ticks = tick + 1;
+            res.inventory_full = true;
+            return res;
+        }
+    }
+}
+
+#endif
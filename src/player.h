@@ -1,27 +1,26 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
-#include "resources.h"
+#include "game_data.h"
+#include "inventory.h"
 
 class Player 
 {
-    std::array<std::optional<Object>, INVENTORY_SIZE> inventory;
+    Inventory inventory;
     PlayerState player_state;
-    size_t inventory_occupancy;
     size_t vault_occupancy;
+    //bumped on every inventory change so screens know when to redraw
+    std::uint64_t inventory_revision = 0;
 
     public:
         void reset() noexcept
         {
-
-            for (auto& slot : inventory)
-                slot.reset();
-
-            inventory_occupancy = 0;
+            inventory.clear();
+            inventory_revision++;
             stopAction();
         }
 
-        Player() noexcept
+        explicit Player(size_t inventory_size = INVENTORY_SIZE) : inventory(inventory_size)
         {
             reset();
         }
@@ -41,37 +40,57 @@ class Player
             player_state = IDLE;
         }
 
-        bool addItem(Object item) //Cannot be Object& because resource needs to return object.name
-        //and after move, item will be eaten up by slot and if item is a reference to object, object will not be able
-        //to return object.name as it will become empty
+        std::optional<size_t> addItem(ObjectId item)
+        {
+            std::optional<size_t> slot = inventory.add(item);
+            if(slot)
+                inventory_revision++;
+            return slot;
+        }
+
+        bool placeItem(size_t slot, ObjectId item)
+        {
+            if(!inventory.place(slot, item))
+                return false;
+            inventory_revision++;
+            return true;
+        }
+
+        bool removeItem(ObjectId item)
+        {
+            if(!inventory.remove(item))
+                return false;
+            inventory_revision++;
+            return true;
+        }
+
+        bool removeItemAt(size_t slot)
+        {
+            if(!inventory.removeAt(slot))
+                return false;
+            inventory_revision++;
+            return true;
+        }
+
+        bool hasInInventory(ObjectId item_name) const noexcept
         {
-            for(auto& slot : inventory)
-                if(!slot.has_value())
-                {
-                    slot.emplace(std::move(item));
-                    inventory_occupancy++;
-                    return true;
-                }
-            return false;
+            return inventory.contains(item_name);
         }
 
-        bool hasInInventory(ObjectName item_name) const noexcept
+        std::uint64_t getInventoryRevision() const noexcept
         {
-            for(const auto& slot : inventory)
-                if(slot.has_value() && slot->name == item_name)
-                    return true;
-            return false;
+            return inventory_revision;
         }
 
         bool isInventoryFull() const noexcept
         {
-            return inventory_occupancy == INVENTORY_SIZE;
+            return inventory.isFull();
         }
 
-        const std::array<std::optional<Object>, INVENTORY_SIZE>& getInventory() const noexcept
+        const Inventory& getInventory() const noexcept
         {
             return inventory;
         }
 };
 
-#endif
\ No newline at end of file
+#endif
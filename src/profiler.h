@@ -0,0 +1,242 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//frame and zone profiler, compiled in only when SKILLQUEST_PROFILE is defined; otherwise every macro below
+//expands to nothing and none of this code exists in the build
+//PROFILE_ZONE("name") times the rest of the enclosing scope, PROFILE_COUNT(counter, n) bumps a per frame
+//counter and PROFILE_FRAME() closes the frame; zones go into a fixed lock-free ring shared by all threads,
+//which keeps the most recent PROFILE_RING_SIZE zones and never allocates or blocks
+
+#ifdef SKILLQUEST_PROFILE
+
+#include "game_data.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+constexpr size_t PROFILE_RING_SIZE = 1 << 16;
+constexpr size_t PROFILE_FRAME_HISTORY = 240;
+static_assert((PROFILE_RING_SIZE & (PROFILE_RING_SIZE - 1)) == 0, "the ring index is masked, keep it a power of two");
+
+enum class ProfileCounter : int
+{
+    DRAW_CALLS,
+    TEXTURE_UPLOADS,
+    COUNT
+};
+constexpr size_t PROFILE_COUNTER_COUNT = static_cast<size_t>(ProfileCounter::COUNT);
+
+struct ProfileEvent
+{
+    const char *name; //string literal, zones are told apart by pointer
+    std::uint64_t start_ns;
+    std::uint64_t end_ns;
+    std::uint32_t thread;
+};
+
+struct ProfileFrame
+{
+    std::uint64_t start_ns;
+    std::uint64_t duration_ns;
+    std::array<std::uint64_t, PROFILE_COUNTER_COUNT> counters;
+};
+
+struct ZoneSummary
+{
+    const char *name;
+    size_t count;
+    std::uint64_t mean_ns;
+    std::uint64_t p99_ns;
+};
+
+class Profiler
+{
+    //each slot is a tiny seqlock: sequence holds the index of the event in it, or EMPTY while it is rewritten
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence{EMPTY};
+        ProfileEvent event{};
+    };
+    static constexpr std::uint64_t EMPTY = ~std::uint64_t{0};
+
+    std::array<Slot, PROFILE_RING_SIZE> ring;
+    std::atomic<std::uint64_t> write_index{0};
+    std::array<std::atomic<std::uint64_t>, PROFILE_COUNTER_COUNT> counters{};
+    std::atomic<std::uint32_t> next_thread{0};
+    //frames are only touched by the thread that calls endFrame
+    std::array<ProfileFrame, PROFILE_FRAME_HISTORY> frames{};
+    size_t frame_count = 0;
+    size_t frame_pos = 0;
+    std::uint64_t frame_start = now();
+
+    Profiler(){}
+
+    public:
+        static Profiler& instance()
+        {
+            static Profiler profiler;
+            return profiler;
+        }
+
+        static std::uint64_t now() noexcept
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        std::uint32_t threadIndex() noexcept
+        {
+            thread_local std::uint32_t index = next_thread.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+
+        void record(const char *name, std::uint64_t start_ns, std::uint64_t end_ns) noexcept
+        {
+            std::uint64_t index = write_index.fetch_add(1, std::memory_order_relaxed);
+            Slot& slot = ring[index & (PROFILE_RING_SIZE - 1)];
+            slot.sequence.store(EMPTY, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.event = {name, start_ns, end_ns, threadIndex()};
+            slot.sequence.store(index, std::memory_order_release);
+        }
+
+        void count(ProfileCounter counter, std::uint64_t n = 1) noexcept
+        {
+            counters[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+        }
+
+        void endFrame() noexcept
+        {
+            std::uint64_t end = now();
+            ProfileFrame& frame = frames[frame_pos];
+            frame.start_ns = frame_start;
+            frame.duration_ns = end - frame_start;
+            for(size_t i=0; i<PROFILE_COUNTER_COUNT; i++)
+                frame.counters[i] = counters[i].exchange(0, std::memory_order_relaxed);
+            frame_pos = (frame_pos + 1) % PROFILE_FRAME_HISTORY;
+            frame_count = std::min(frame_count + 1, PROFILE_FRAME_HISTORY);
+            frame_start = end;
+        }
+
+        size_t getFrameCount() const noexcept
+        {
+            return frame_count;
+        }
+
+        //age 0 is the last finished frame
+        const ProfileFrame& getFrame(size_t age) const noexcept
+        {
+            return frames[(frame_pos + PROFILE_FRAME_HISTORY - 1 - age) % PROFILE_FRAME_HISTORY];
+        }
+
+        //copies the zones that started at or after since_ns and are still in the ring, newest first
+        void collect(std::vector<ProfileEvent>& out, std::uint64_t since_ns = 0) const
+        {
+            out.clear();
+            std::uint64_t end = write_index.load(std::memory_order_acquire);
+            std::uint64_t begin = end > PROFILE_RING_SIZE ? end - PROFILE_RING_SIZE : 0;
+            for(std::uint64_t index = end; index-- > begin;)
+            {
+                const Slot& slot = ring[index & (PROFILE_RING_SIZE - 1)];
+                if(slot.sequence.load(std::memory_order_acquire) != index)
+                    continue;
+                ProfileEvent event = slot.event;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(slot.sequence.load(std::memory_order_relaxed) != index)
+                    continue;
+                if(event.start_ns >= since_ns)
+                    out.push_back(event);
+            }
+        }
+
+        //per zone call count, mean and p99 over the frames in the history
+        void summarize(std::vector<ZoneSummary>& out, std::vector<ProfileEvent>& scratch) const
+        {
+            out.clear();
+            if(frame_count == 0)
+                return;
+            collect(scratch, getFrame(frame_count - 1).start_ns);
+            std::sort(scratch.begin(), scratch.end(), [](const ProfileEvent& a, const ProfileEvent& b)
+            {
+                if(a.name != b.name)
+                    return std::less<const char*>()(a.name, b.name);
+                return a.end_ns - a.start_ns < b.end_ns - b.start_ns;
+            });
+            for(size_t first=0; first<scratch.size();)
+            {
+                size_t last = first;
+                std::uint64_t total = 0;
+                while(last < scratch.size() && scratch[last].name == scratch[first].name)
+                {
+                    total += scratch[last].end_ns - scratch[last].start_ns;
+                    last++;
+                }
+                size_t count = last - first;
+                const ProfileEvent& p99 = scratch[first + std::min(count - 1, (count * 99) / 100)];
+                out.push_back({scratch[first].name, count, total / count, p99.end_ns - p99.start_ns});
+                first = last;
+            }
+            std::sort(out.begin(), out.end(), [](const ZoneSummary& a, const ZoneSummary& b)
+            {
+                return a.mean_ns * a.count > b.mean_ns * b.count;
+            });
+        }
+
+        //writes the zones in the ring as a Chrome trace (chrome://tracing, Perfetto), complete events in microseconds
+        bool exportChromeTrace(const std::filesystem::path& path) const
+        {
+            std::vector<ProfileEvent> events;
+            collect(events);
+            std::FILE *file = std::fopen(path.string().c_str(), "wb");
+            if(!file)
+                return false;
+            std::uint64_t origin = ~std::uint64_t{0};
+            for(const ProfileEvent& event : events)
+                origin = std::min(origin, event.start_ns);
+            std::fputs("{\"traceEvents\":[\n", file);
+            for(size_t i=events.size(); i-- > 0;)
+            {
+                const ProfileEvent& event = events[i];
+                std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                    event.name, event.thread, static_cast<double>(event.start_ns - origin) / 1000.0,
+                    static_cast<double>(event.end_ns - event.start_ns) / 1000.0, i > 0 ? "," : "");
+            }
+            std::fputs("]}\n", file);
+            return std::fclose(file) == 0;
+        }
+};
+
+class ProfileScope
+{
+    const char *name;
+    std::uint64_t start;
+
+    public:
+        explicit ProfileScope(const char *name) noexcept : name(name), start(Profiler::now())
+        {}
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+        ~ProfileScope()
+        {
+            Profiler::instance().record(name, start, Profiler::now());
+        }
+};
+
+#define PROFILE_JOIN_INNER(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileScope PROFILE_JOIN(profile_zone_, __LINE__)(name)
+#define PROFILE_COUNT(counter, n) Profiler::instance().count(ProfileCounter::counter, n)
+#define PROFILE_FRAME() Profiler::instance().endFrame()
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_COUNT(counter, n)
+#define PROFILE_FRAME()
+
+#endif
+
+#endif
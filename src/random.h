@@ -1,9 +1,165 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+//seedable random numbers, the same seed gives the same sequence on every platform and build
+//Rng is xoshiro256**, seeded through splitmix64; RngService hands out one independent Rng per stream so
+//drawing more numbers for one purpose (say world generation) never shifts the sequence of another (drops)
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
 #include <random>
 
-std::mt19937 rng{ std::random_device{}() };
+constexpr std::uint64_t DEFAULT_RNG_SEED = 0x5EED5EED5EED5EEDull;
+
+enum class RngStream : std::uint8_t
+{
+    DROPS,
+    WORLD,
+    COUNT
+};
+
+constexpr size_t RNG_STREAM_COUNT = static_cast<size_t>(RngStream::COUNT);
+
+constexpr std::uint64_t splitmix64(std::uint64_t& state) noexcept
+{
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+class Rng
+{
+    std::array<std::uint64_t, 4> state;
+
+    static constexpr std::uint64_t rotl(std::uint64_t x, int k) noexcept
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    public:
+        explicit constexpr Rng(std::uint64_t seed = DEFAULT_RNG_SEED) noexcept : state{}
+        {
+            reseed(seed);
+        }
+
+        constexpr void reseed(std::uint64_t seed) noexcept
+        {
+            for(std::uint64_t& word : state)
+                word = splitmix64(seed);
+        }
+
+        constexpr std::uint64_t next() noexcept
+        {
+            std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+            std::uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+
+        //uniform in [0, range), unbiased (Lemire's multiply and reject), range must be at least 1
+        constexpr std::uint32_t bounded(std::uint32_t range) noexcept
+        {
+            std::uint64_t m = (next() >> 32) * range;
+            std::uint32_t low = static_cast<std::uint32_t>(m);
+            if(low < range)
+            {
+                std::uint32_t threshold = static_cast<std::uint32_t>(-range) % range;
+                while(low < threshold)
+                {
+                    m = (next() >> 32) * range;
+                    low = static_cast<std::uint32_t>(m);
+                }
+            }
+            return static_cast<std::uint32_t>(m >> 32);
+        }
 
-int random_int(int min, int max)
+        //uniform in [min, max]
+        constexpr int between(int min, int max) noexcept
+        {
+            return min + static_cast<int>(bounded(static_cast<std::uint32_t>(max - min) + 1));
+        }
+
+        //uniform in (0, 1], safe to take the log of
+        constexpr double unit() noexcept
+        {
+            return static_cast<double>((next() >> 11) + 1) * 0x1.0p-53;
+        }
+
+        //bulk generation for callers that need many numbers at once, same sequence as calling next() n times
+        constexpr void fill(std::uint64_t *out, size_t n) noexcept
+        {
+            for(size_t i=0; i<n; i++)
+                out[i] = next();
+        }
+
+        constexpr void fillUnit(double *out, size_t n) noexcept
+        {
+            for(size_t i=0; i<n; i++)
+                out[i] = unit();
+        }
+
+        constexpr const std::array<std::uint64_t, 4>& getState() const noexcept
+        {
+            return state;
+        }
+
+        //an all zero state would only ever produce zeros, so it is rejected
+        constexpr bool setState(const std::array<std::uint64_t, 4>& new_state) noexcept
+        {
+            if((new_state[0] | new_state[1] | new_state[2] | new_state[3]) == 0)
+                return false;
+            state = new_state;
+            return true;
+        }
+};
+
+//one seed for a whole game, every stream is derived from it
+class RngService
+{
+    std::uint64_t seed_value = DEFAULT_RNG_SEED;
+    std::array<Rng, RNG_STREAM_COUNT> streams;
+
+    public:
+        explicit RngService(std::uint64_t seed = DEFAULT_RNG_SEED) noexcept
+        {
+            reseed(seed);
+        }
+
+        void reseed(std::uint64_t seed) noexcept
+        {
+            seed_value = seed;
+            for(size_t i=0; i<RNG_STREAM_COUNT; i++)
+                streams[i].reseed(seed ^ (0xD1B54A32D192ED03ull * (i + 1)));
+        }
+
+        std::uint64_t getSeed() const noexcept
+        {
+            return seed_value;
+        }
+
+        Rng& stream(RngStream id) noexcept
+        {
+            return streams[static_cast<size_t>(id)];
+        }
+
+        const Rng& stream(RngStream id) const noexcept
+        {
+            return streams[static_cast<size_t>(id)];
+        }
+};
+
+//a fresh seed for a new game
+std::uint64_t random_seed()
 {
-    std::uniform_int_distribution<int> dist(min, max);
-    return dist(rng);
-}
\ No newline at end of file
+    std::random_device device;
+    return (static_cast<std::uint64_t>(device()) << 32) ^ device();
+}
+
+#endif
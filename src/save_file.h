@@ -0,0 +1,398 @@
+#ifndef SAVE_FILE_H
+#define SAVE_FILE_H
+
+//versioned binary save files
+//layout: a SAVE_HEADER_SIZE byte header followed by sections, each a 4 byte tag, a u32 payload size and the payload
+//integers are little endian, the crc32 in the header covers every byte after it
+//readers skip sections they do not know and ignore trailing bytes in ones they do, so a newer file still loads
+//unless its min_reader_version says the layout changed incompatibly
+
+#include "game_data.h"
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+constexpr std::array<char, 4> SAVE_MAGIC = {'S', 'Q', 'S', 'V'};
+//version 3 saves objects and resources as u16 ids, mapped back to the content by their keys
+constexpr std::uint16_t SAVE_VERSION = 3;
+//oldest reader that understands files written by this version
+constexpr std::uint16_t SAVE_MIN_READER_VERSION = 3;
+//magic, crc32, version, min reader version, section count, payload size
+constexpr size_t SAVE_HEADER_SIZE = 24;
+constexpr size_t SAVE_CRC_OFFSET = 4;
+
+constexpr std::uint32_t make_tag(const char (&name)[5])
+{
+    return static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[0])) |
+        (static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[1])) << 8) |
+        (static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[2])) << 16) |
+        (static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[3])) << 24);
+}
+
+constexpr std::uint32_t SAVE_TAG_META = make_tag("META");
+constexpr std::uint32_t SAVE_TAG_PLAYER = make_tag("PLYR");
+//text log as plain words, written before messages were stored as ids and no longer read
+constexpr std::uint32_t SAVE_TAG_LOG = make_tag("TLOG");
+constexpr std::uint32_t SAVE_TAG_JOURNAL = make_tag("JRNL");
+constexpr std::uint32_t SAVE_TAG_RNG = make_tag("RNGS");
+constexpr std::uint32_t SAVE_TAG_MESSAGES = make_tag("MSGS");
+//keys of the object and resource ids the other sections use, from version 3 on
+constexpr std::uint32_t SAVE_TAG_KEYS = make_tag("KEYS");
+
+
+consteval std::array<std::uint32_t, 256> make_crc32_table()
+{
+    std::array<std::uint32_t, 256> table{};
+    for(std::uint32_t i=0; i<256; i++)
+    {
+        std::uint32_t c = i;
+        for(int k=0; k<8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+constexpr std::array<std::uint32_t, 256> CRC32_TABLE = make_crc32_table();
+
+std::uint32_t crc32(const std::uint8_t *data, size_t size) noexcept
+{
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for(size_t i=0; i<size; i++)
+        crc = CRC32_TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+//bounds checked little endian cursor over bytes owned by someone else, reads past the end yield 0 and clear ok
+struct ByteReader
+{
+    const std::uint8_t *data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+    bool ok = true;
+
+    bool has(size_t n) noexcept
+    {
+        if(!ok || size - pos < n)
+        {
+            ok = false;
+            return false;
+        }
+        return true;
+    }
+
+    std::uint64_t getLE(size_t n) noexcept
+    {
+        if(!has(n))
+            return 0;
+        std::uint64_t value = 0;
+        for(size_t i=0; i<n; i++)
+            value |= static_cast<std::uint64_t>(data[pos + i]) << (8 * i);
+        pos += n;
+        return value;
+    }
+
+    std::uint8_t get8() noexcept { return static_cast<std::uint8_t>(getLE(1)); }
+    std::uint16_t get16() noexcept { return static_cast<std::uint16_t>(getLE(2)); }
+    std::uint32_t get32() noexcept { return static_cast<std::uint32_t>(getLE(4)); }
+    std::uint64_t get64() noexcept { return getLE(8); }
+
+    //view into the underlying bytes, valid as long as they are
+    std::string_view getBytes(size_t n) noexcept
+    {
+        if(!has(n))
+            return {};
+        std::string_view view(reinterpret_cast<const char*>(data + pos), n);
+        pos += n;
+        return view;
+    }
+};
+
+//writes next to the target, flushes to disk and renames over it, so a crash leaves either the old or the new file
+bool write_file_atomically(const std::filesystem::path& path, const std::vector<std::uint8_t>& bytes)
+{
+    std::error_code ec;
+    if(path.has_parent_path())
+        std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path tmp_path = path;
+    tmp_path += ".tmp";
+
+    std::FILE *file = std::fopen(tmp_path.string().c_str(), "wb");
+    if(!file)
+        return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    ok = (std::fflush(file) == 0) && ok;
+#ifdef _WIN32
+    ok = (_commit(_fileno(file)) == 0) && ok;
+#else
+    ok = (fsync(fileno(file)) == 0) && ok;
+#endif
+    ok = (std::fclose(file) == 0) && ok;
+    if(!ok)
+    {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    std::filesystem::rename(tmp_path, path, ec);
+    return !ec;
+}
+
+class SaveWriter
+{
+    std::vector<std::uint8_t> buffer;
+    size_t section_start = 0;
+    std::uint32_t section_count = 0;
+
+    void patch32(size_t offset, std::uint32_t value) noexcept
+    {
+        for(size_t i=0; i<4; i++)
+            buffer[offset + i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+
+    public:
+        SaveWriter()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            buffer.assign(SAVE_HEADER_SIZE, 0);
+            section_count = 0;
+        }
+
+        void putLE(std::uint64_t value, size_t n)
+        {
+            for(size_t i=0; i<n; i++)
+                buffer.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+
+        void put8(std::uint8_t value) { putLE(value, 1); }
+        void put16(std::uint16_t value) { putLE(value, 2); }
+        void put32(std::uint32_t value) { putLE(value, 4); }
+        void put64(std::uint64_t value) { putLE(value, 8); }
+
+        void putBytes(const void *data, size_t size)
+        {
+            const std::uint8_t *bytes = static_cast<const std::uint8_t*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+
+        void beginSection(std::uint32_t tag)
+        {
+            put32(tag);
+            section_start = buffer.size();
+            put32(0);
+        }
+
+        void endSection()
+        {
+            patch32(section_start, static_cast<std::uint32_t>(buffer.size() - section_start - 4));
+            section_count++;
+        }
+
+        //fills in the header, the returned bytes are the complete file
+        const std::vector<std::uint8_t>& finish()
+        {
+            std::memcpy(buffer.data(), SAVE_MAGIC.data(), SAVE_MAGIC.size());
+            buffer[8] = static_cast<std::uint8_t>(SAVE_VERSION);
+            buffer[9] = static_cast<std::uint8_t>(SAVE_VERSION >> 8);
+            buffer[10] = static_cast<std::uint8_t>(SAVE_MIN_READER_VERSION);
+            buffer[11] = static_cast<std::uint8_t>(SAVE_MIN_READER_VERSION >> 8);
+            patch32(12, section_count);
+            std::uint64_t payload_size = buffer.size() - SAVE_HEADER_SIZE;
+            for(size_t i=0; i<8; i++)
+                buffer[16 + i] = static_cast<std::uint8_t>(payload_size >> (8 * i));
+            patch32(SAVE_CRC_OFFSET, crc32(buffer.data() + SAVE_CRC_OFFSET + 4, buffer.size() - SAVE_CRC_OFFSET - 4));
+            return buffer;
+        }
+
+        //hands over the complete file, leaving the writer empty
+        std::vector<std::uint8_t> takeBytes()
+        {
+            finish();
+            std::vector<std::uint8_t> bytes = std::move(buffer);
+            reset();
+            return bytes;
+        }
+
+        bool writeAtomically(const std::filesystem::path& path)
+        {
+            return write_file_atomically(path, finish());
+        }
+};
+
+//read only memory mapping of a whole file
+class MappedFile
+{
+    const std::uint8_t *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    public:
+        MappedFile(){}
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            close();
+        }
+
+        bool open(const std::filesystem::path& path)
+        {
+            close();
+#ifdef _WIN32
+            file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if(file == INVALID_HANDLE_VALUE)
+                return false;
+            LARGE_INTEGER file_size;
+            if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+            {
+                close();
+                return false;
+            }
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(!mapping)
+            {
+                close();
+                return false;
+            }
+            data = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = static_cast<size_t>(file_size.QuadPart);
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if(fd < 0)
+                return false;
+            struct stat st;
+            if(fstat(fd, &st) != 0 || st.st_size == 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            void *mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if(mapped == MAP_FAILED)
+                return false;
+            data = static_cast<const std::uint8_t*>(mapped);
+            size = static_cast<size_t>(st.st_size);
+#endif
+            if(!data)
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        void close() noexcept
+        {
+#ifdef _WIN32
+            if(data)
+                UnmapViewOfFile(data);
+            if(mapping)
+                CloseHandle(mapping);
+            if(file != INVALID_HANDLE_VALUE)
+                CloseHandle(file);
+            mapping = nullptr;
+            file = INVALID_HANDLE_VALUE;
+#else
+            if(data)
+                munmap(const_cast<std::uint8_t*>(data), size);
+#endif
+            data = nullptr;
+            size = 0;
+        }
+
+        const std::uint8_t* getData() const noexcept
+        {
+            return data;
+        }
+
+        size_t getSize() const noexcept
+        {
+            return size;
+        }
+};
+
+//validates a mapped save and hands out readers over its sections without copying them
+class SaveReader
+{
+    MappedFile file;
+    std::uint16_t version = 0;
+    std::string error;
+
+    bool fail(std::string message)
+    {
+        error = std::move(message);
+        file.close();
+        return false;
+    }
+
+    public:
+        bool open(const std::filesystem::path& path)
+        {
+            error.clear();
+            if(!file.open(path))
+                return fail("cannot open " + path.string());
+            ByteReader header{file.getData(), file.getSize()};
+            std::string_view magic = header.getBytes(SAVE_MAGIC.size());
+            std::uint32_t crc = header.get32();
+            version = header.get16();
+            std::uint16_t min_reader_version = header.get16();
+            header.get32();
+            std::uint64_t payload_size = header.get64();
+            if(!header.ok || magic != std::string_view(SAVE_MAGIC.data(), SAVE_MAGIC.size()))
+                return fail("not a save file");
+            if(min_reader_version > SAVE_VERSION)
+                return fail("save was written by a newer, incompatible version");
+            if(payload_size != file.getSize() - SAVE_HEADER_SIZE)
+                return fail("save file is truncated");
+            if(crc != crc32(file.getData() + SAVE_CRC_OFFSET + 4, file.getSize() - SAVE_CRC_OFFSET - 4))
+                return fail("save file is corrupted");
+            return true;
+        }
+
+        std::uint16_t getVersion() const noexcept
+        {
+            return version;
+        }
+
+        const std::string& getError() const noexcept
+        {
+            return error;
+        }
+
+        //reader over the first section with this tag, nullopt if the file has none
+        std::optional<ByteReader> section(std::uint32_t tag) const noexcept
+        {
+            ByteReader sections{file.getData(), file.getSize(), SAVE_HEADER_SIZE};
+            while(sections.ok && sections.pos < sections.size)
+            {
+                std::uint32_t section_tag = sections.get32();
+                std::uint32_t section_size = sections.get32();
+                if(!sections.has(section_size))
+                    return std::nullopt;
+                if(section_tag == tag)
+                    return ByteReader{file.getData() + sections.pos, section_size};
+                sections.pos += section_size;
+            }
+            return std::nullopt;
+        }
+};
+
+#endif
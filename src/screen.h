@@ -6,11 +6,80 @@
 class Screen
 {
     SDL_FRect rect;
+    SDL_Texture *cache = nullptr;
+    bool cache_failed = false;
+    bool dirty = true;
+
+    protected:
+        //returns true when the screen has to be drawn, either into its stale cache or directly
+        //if render targets are unsupported, the caller follows up with endCache
+        bool beginCache(SDL_Renderer *renderer)
+        {
+            if(!cache && !cache_failed)
+            {
+                //the target covers the screen only, whole pixels around it
+                int w = static_cast<int>(std::ceil(rect.x + rect.w)) - static_cast<int>(std::floor(rect.x));
+                int h = static_cast<int>(std::ceil(rect.y + rect.h)) - static_cast<int>(std::floor(rect.y));
+                cache = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, w, h);
+                PROFILE_COUNT(TEXTURE_UPLOADS, 1);
+                if(!cache)
+                    cache_failed = true;
+                else
+                    SDL_SetTextureBlendMode(cache, SDL_BLENDMODE_NONE);
+                dirty = true;
+            }
+            if(!cache)
+                return true;
+            if(!dirty)
+                return false;
+            SDL_SetRenderTarget(renderer, cache);
+            //screens draw in window coordinates, the viewport moves the screen's corner to the target's
+            SDL_Rect viewport = {-static_cast<int>(std::floor(rect.x)), -static_cast<int>(std::floor(rect.y)),
+                static_cast<int>(std::ceil(rect.x + rect.w)), static_cast<int>(std::ceil(rect.y + rect.h))};
+            SDL_SetRenderViewport(renderer, &viewport);
+            SDL_SetRenderDrawColor(renderer, BLACK.r, BLACK.g, BLACK.b, BLACK.a);
+            SDL_RenderClear(renderer);
+            return true;
+        }
+
+        void endCache(SDL_Renderer *renderer)
+        {
+            if(!cache)
+                return;
+            SDL_SetRenderViewport(renderer, nullptr);
+            SDL_SetRenderTarget(renderer, nullptr);
+            dirty = false;
+        }
+
+        void blitCache(SDL_Renderer *renderer) const
+        {
+            if(cache)
+            {
+                SDL_FRect src = {rect.x - std::floor(rect.x), rect.y - std::floor(rect.y), rect.w, rect.h};
+                SDL_RenderTexture(renderer, cache, &src, &rect);
+                PROFILE_COUNT(DRAW_CALLS, 1);
+            }
+        }
 
     public:
         explicit Screen(float x, float y, float w, float h) : rect{x, y, w, h}
         {}
 
+        void markDirty() noexcept
+        {
+            dirty = true;
+        }
+
+        //must run before the renderer that owns the cache is destroyed
+        void releaseCache() noexcept
+        {
+            if(cache)
+                SDL_DestroyTexture(cache);
+            cache = nullptr;
+            cache_failed = false;
+            dirty = true;
+        }
+
         float getX() const noexcept
         {
             return rect.x;
@@ -31,10 +100,16 @@ class Screen
             return rect.h;
         }
 
+        bool contains(float x, float y) const noexcept
+        {
+            return x >= rect.x && x < rect.x + rect.w && y >= rect.y && y < rect.y + rect.h;
+        }
+
         void renderBox(SDL_Renderer *renderer, SDL_Color color = WHITE) const
         {
             SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
             SDL_RenderRect(renderer, &rect);
+            PROFILE_COUNT(DRAW_CALLS, 1);
         }
 };
 
@@ -0,0 +1,530 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+//the simulation on its own thread, ticking at TICK cadence whatever the frame rate, so a slow frame (text
+//rasterization, texture uploads) never delays a tick and a burst of ticks never delays a frame
+//the render thread sends commands through a lock-free queue and draws the latest FrameSnapshot, published
+//through a triple buffer after every tick and command; the journal, the autosaves and the message log all
+//belong to this thread, the render thread only ever sees snapshots
+
+#include "simulation.h"
+#include "message_log.h"
+#include "autosave.h"
+#include "journal.h"
+#include "frame_scheduler.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+#include <chrono>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+
+constexpr size_t SIM_COMMAND_QUEUE_SIZE = 64;
+
+enum class SimCommandType
+{
+    NEW_GAME,
+    LOAD_GAME, //value is the slot
+    SAVE_GAME, //value is the slot
+    END_GAME,
+    PAUSE,
+    RESUME,
+    START_MINING, //value is the ResourceId
+    SET_CONTENT //takes the content handed over by SimThread::setContent
+};
+
+struct SimCommand
+{
+    SimCommandType type;
+    size_t value;
+};
+
+struct FrameSnapshot
+{
+    //commands applied so far, they are applied in the order they were sent
+    std::uint64_t handled_commands = 0;
+    //a game was started or loaded and has not been ended
+    bool in_game = false;
+    bool show_inventory = false;
+    PlayerState action = IDLE;
+    std::optional<ResourceId> target;
+    //the game's seed, the render thread generates the world map from it
+    std::uint64_t world_seed = 0;
+    //when the next tick is due on SDL's clock
+    Uint64 next_tick_ns = 0;
+    InventoryView inventory;
+    MessageLog log;
+
+    //how far the current tick is at time now, in [0, 1]
+    float tickProgress(Uint64 now) const noexcept
+    {
+        if(next_tick_ns <= now)
+            return 1.0f;
+        return std::max(1.0f - static_cast<float>(next_tick_ns - now) / static_cast<float>(TICK_NS), 0.0f);
+    }
+};
+
+class SimThread
+{
+    //simulation thread only
+    Simulation simulation = Simulation();
+    MessageLog log;
+    FrameScheduler scheduler = FrameScheduler(TICK_NS, TICK_NS, MAX_TICK_BACKLOG);
+    Autosaver autosaver;
+    std::vector<SaveResult> save_results;
+    std::uint64_t ticks_since_autosave = 0;
+    //every autosave is a checkpoint: the snapshot carries checkpoint_id and journal records what happens after it
+    Journal journal;
+    std::uint64_t checkpoint_id = 0;
+    //a game was started or loaded and has not ticked yet, its first checkpoint is written before its first tick
+    bool journal_pending = false;
+    std::uint64_t handled_commands = 0;
+    bool in_game = false;
+    bool paused = false;
+    bool show_inventory = false;
+
+    //render thread only
+    std::uint64_t sent_commands = 0;
+
+    //shared
+    SpscQueue<SimCommand, SIM_COMMAND_QUEUE_SIZE> commands;
+    //released once per command and on stop, the simulation thread sleeps on it between ticks
+    std::counting_semaphore<> wake{0};
+    std::atomic<bool> stopping{false};
+    TripleBuffer<FrameSnapshot> snapshots;
+    //reloaded content waiting for its SET_CONTENT command, swapped in between ticks
+    std::mutex content_mutex;
+    std::shared_ptr<const Content> pending_content;
+    std::thread worker;
+
+    void run()
+    {
+        scheduler.start();
+        publish();
+        while(!stopping.load(std::memory_order_acquire))
+        {
+            while(std::optional<SimCommand> command = commands.pop())
+            {
+                handle(*command);
+                handled_commands++;
+            }
+
+            scheduler.beginFrame();
+            if(!in_game)
+                scheduler.takeTicks(scheduler.pendingTicks());
+            else if(!paused)
+            {
+                if(journal_pending && scheduler.pendingTicks() > 0)
+                    beginJournal();
+                //time spent paused is credited here once play resumes
+                if(scheduler.pendingTicks() >= FAST_FORWARD_MIN_TICKS)
+                {
+                    std::uint64_t ticks_due = scheduler.takeTicks(scheduler.pendingTicks());
+                    simulation.fastForward(ticks_due);
+                    ticks_since_autosave += ticks_due;
+                }
+                std::uint64_t ticks_due = scheduler.takeTicks(MAX_CATCHUP_TICKS);
+                for(std::uint64_t i=0; i<ticks_due; i++)
+                    updateState();
+                ticks_since_autosave += ticks_due;
+                if(ticks_since_autosave >= AUTOSAVE_INTERVAL_TICKS)
+                    saveGame(AUTOSAVE_SLOT);
+            }
+            processSimulationEvents();
+            {
+                PROFILE_ZONE("Journal::commit");
+                journal.commit();
+            }
+            processSaveResults();
+            publish();
+            waitForWork();
+        }
+
+        if(scheduler.getDroppedTicks() > 0)
+            std::cerr<<"Dropped "<<scheduler.getDroppedTicks()<<" ticks of backlog beyond "<<MAX_TICK_BACKLOG<<"\n";
+        endJournal();
+        autosaver.shutdown();
+        processSaveResults();
+    }
+
+    //sleeps until the next tick is due or a command arrives, outside of play only a command wakes it
+    void waitForWork()
+    {
+        if(!in_game || paused)
+        {
+            wake.acquire();
+            return;
+        }
+        Uint64 now = SDL_GetTicksNS();
+        Uint64 due = scheduler.nextTickAt();
+        if(due > now)
+            (void)wake.try_acquire_for(std::chrono::nanoseconds(due - now));
+    }
+
+    void handle(const SimCommand& command)
+    {
+        switch(command.type)
+        {
+            case SimCommandType::NEW_GAME:
+            {
+                newGame();
+                break;
+            }
+            case SimCommandType::LOAD_GAME:
+            {
+                loadGame(command.value);
+                break;
+            }
+            case SimCommandType::SAVE_GAME:
+            {
+                if(in_game)
+                    saveGame(command.value);
+                break;
+            }
+            case SimCommandType::END_GAME:
+            {
+                endJournal();
+                journal_pending = false;
+                in_game = false;
+                break;
+            }
+            case SimCommandType::PAUSE:
+            {
+                paused = true;
+                break;
+            }
+            case SimCommandType::RESUME:
+            {
+                paused = false;
+                break;
+            }
+            case SimCommandType::START_MINING:
+            {
+                if(in_game && command.value < simulation.getContent().resourceCount())
+                    simulation.startMining(static_cast<ResourceId>(command.value));
+                break;
+            }
+            case SimCommandType::SET_CONTENT:
+            {
+                std::shared_ptr<const Content> content;
+                {
+                    std::lock_guard<std::mutex> lock(content_mutex);
+                    content = std::move(pending_content);
+                }
+                if(!content)
+                    break;
+                log.remap(simulation.setContent(std::move(content)));
+                //the journal holds ids of the old content, a new chain starts in the new ids; its snapshot has to be
+                //on disk before the journal, or recovery would read the journal through the old snapshot's keys
+                if(in_game && !journal_pending)
+                {
+                    journal.commit();
+                    beginJournal();
+                }
+                break;
+            }
+        }
+    }
+
+    //copies what the render thread draws into the back slot, the inventory only when it changed and the log
+    //only from the first message the slot has not seen
+    void publish()
+    {
+        FrameSnapshot& snapshot = snapshots.writeBuffer();
+        snapshot.handled_commands = handled_commands;
+        snapshot.in_game = in_game;
+        snapshot.show_inventory = show_inventory;
+        snapshot.action = simulation.getPlayer().getAction();
+        snapshot.target = simulation.getPlayerTarget();
+        snapshot.world_seed = simulation.getSeed();
+        snapshot.next_tick_ns = scheduler.nextTickAt();
+        const Player& player = simulation.getPlayer();
+        if(snapshot.inventory.revision != player.getInventoryRevision() || snapshot.inventory.slots.empty())
+            snapshot.inventory.assign(player.getInventory(), player.getInventoryRevision());
+        snapshot.log.copyFrom(log);
+        snapshots.publish();
+    }
+
+    void newGame()
+    {
+        simulation.attachJournal(nullptr);
+        simulation.reset();
+        simulation.seed(random_seed());
+        ticks_since_autosave = 0;
+        show_inventory = false;
+        paused = false;
+        log.clear();
+        log.push(MessageId::WELCOME);
+        deferJournal();
+        in_game = true;
+        //the time spent in the menus is not the new game's
+        scheduler.start();
+    }
+
+    //closes the journal of the game before, the new game's chain begins with its first tick so a game that is
+    //started or loaded and left again without playing never replaces the autosave or the journals on disk
+    void deferJournal()
+    {
+        simulation.attachJournal(nullptr);
+        journal.close();
+        journal_pending = true;
+    }
+
+    //starts a new checkpoint chain for the game that was just created or loaded, or whose content was reloaded
+    //its id is above every journal on disk and the first snapshot is on disk before its journal exists,
+    //so recovery never pairs an autosave with a journal of another game or content; this waits on the disk once
+    //per session and per reload, on this thread
+    void beginJournal()
+    {
+        journal_pending = false;
+        journal.close();
+        for(std::uint64_t id : journal_ids())
+            checkpoint_id = std::max(checkpoint_id, id);
+        checkpoint_id++;
+        SaveWriter writer;
+        writeSave(writer);
+        autosaver.submit(saveSlotPath(AUTOSAVE_SLOT), writer, checkpoint_id);
+        autosaver.flush();
+        processSaveResults();
+        if(!journal.open(checkpoint_id))
+            std::cerr<<"Failed to open journal "<<journal_path(checkpoint_id).string()<<", progress since the last autosave is not protected\n";
+        simulation.attachJournal(&journal);
+        ticks_since_autosave = 0;
+    }
+
+    //snapshots the game and switches to a fresh journal, the old one is deleted once the snapshot is on disk
+    void checkpoint()
+    {
+        journal.commit();
+        checkpoint_id++;
+        if(journal.isOpen() && !journal.open(checkpoint_id))
+            std::cerr<<"Failed to open journal "<<journal_path(checkpoint_id).string()<<"\n";
+        SaveWriter writer;
+        writeSave(writer);
+        autosaver.submit(saveSlotPath(AUTOSAVE_SLOT), writer, checkpoint_id);
+        ticks_since_autosave = 0;
+    }
+
+    //final checkpoint when leaving a game, once it is written no journal is left behind
+    void endJournal()
+    {
+        if(!journal.isOpen())
+            return;
+        simulation.attachJournal(nullptr);
+        journal.commit();
+        journal.close();
+        checkpoint_id++;
+        SaveWriter writer;
+        writeSave(writer);
+        autosaver.submit(saveSlotPath(AUTOSAVE_SLOT), writer, checkpoint_id);
+    }
+
+    std::filesystem::path saveSlotPath(size_t slot) const
+    {
+        if(slot == AUTOSAVE_SLOT)
+            return SAVE_DIRECTORY + "autosave.sqs";
+        return SAVE_DIRECTORY + "slot" + std::to_string(slot + 1) + ".sqs";
+    }
+
+    //meta section: wall clock time of the save in ms since the epoch, used to credit offline mining
+    //journal section: the checkpoint id, only meaningful for the autosave slot
+    void writeSave(SaveWriter& writer) const
+    {
+        writer.beginSection(SAVE_TAG_META);
+        writer.put64(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count()));
+        writer.endSection();
+
+        writer.beginSection(SAVE_TAG_JOURNAL);
+        writer.put64(checkpoint_id);
+        writer.endSection();
+
+        simulation.writeSave(writer);
+        log.writeSave(writer);
+    }
+
+    //snapshots the game now, the file itself is written by the autosaver thread
+    void saveGame(size_t slot)
+    {
+        if(slot == AUTOSAVE_SLOT)
+        {
+            checkpoint();
+            return;
+        }
+        SaveWriter writer;
+        writeSave(writer);
+        autosaver.submit(saveSlotPath(slot), writer);
+    }
+
+    void processSaveResults()
+    {
+        autosaver.pollCompleted(save_results);
+        for(const SaveResult& result : save_results)
+        {
+            bool autosave = (result.path == saveSlotPath(AUTOSAVE_SLOT));
+            if(autosave && result.ok)
+                remove_journals_before(result.tag);
+            if(!result.ok)
+            {
+                std::cerr<<"Failed to write "<<result.path.string()<<"\n";
+                log.push(MessageId::SAVING_FAILED);
+            }
+            else if(!autosave)
+                log.push(MessageId::GAME_SAVED);
+        }
+    }
+
+    //on failure the game that was running, if any, is left as it was
+    bool loadGame(size_t slot)
+    {
+        SaveReader reader;
+        if(!reader.open(saveSlotPath(slot)))
+        {
+            std::cerr<<"Failed to load slot "<<slot + 1<<": "<<reader.getError()<<"\n";
+            return false;
+        }
+        simulation.attachJournal(nullptr);
+        IdMap ids = simulation.getContent().readKeys(reader);
+        if(!simulation.readSave(reader, ids))
+        {
+            std::cerr<<"Failed to load slot "<<slot + 1<<": player data is missing or damaged\n";
+            simulation.reset();
+            in_game = false;
+            return false;
+        }
+
+        log.readSave(reader, ids);
+        std::uint64_t saved_at = 0;
+        if(std::optional<ByteReader> meta = reader.section(SAVE_TAG_META))
+            saved_at = meta->get64();
+        std::optional<ByteReader> journal_section = reader.section(SAVE_TAG_JOURNAL);
+        std::uint64_t snapshot_id = journal_section ? journal_section->get64() : 0;
+        checkpoint_id = snapshot_id;
+        //recovery: the journals that follow the autosave hold whatever happened before the game last stopped
+        if(slot == AUTOSAVE_SLOT && journal_section && journal_section->ok)
+        {
+            size_t replayed = 0;
+            JournalReader journal_reader;
+            for(std::uint64_t id = snapshot_id; journal_reader.open(journal_path(id)) && journal_reader.getCheckpointId() == id; id++)
+            {
+                replayed += simulation.replayJournal(journal_reader, ids);
+                saved_at = std::max(saved_at, journal_reader.getLastCommitMs());
+                checkpoint_id = id;
+            }
+            if(replayed > 0)
+                log.push(MessageId::RECOVERED);
+        }
+        show_inventory = (simulation.getPlayer().getAction() == MINING);
+
+        std::uint64_t now = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        if(saved_at > 0 && now > saved_at)
+            simulation.fastForward((now - saved_at) / TICK);
+        deferJournal();
+        paused = false;
+        in_game = true;
+        //everything up to now was credited from saved_at, the time spent in the menus must not be again
+        scheduler.start();
+        return true;
+    }
+
+    void updateState()
+    {
+        PROFILE_ZONE("SimThread::updateState");
+        simulation.tick();
+    }
+
+    //turns what the simulation did into messages
+    void processSimulationEvents()
+    {
+        for(const SimEvent& event : simulation.getEvents())
+        {
+            switch(event.type)
+            {
+                case SimEventType::STARTED_MINING:
+                {
+                    show_inventory = true;
+                    log.startedMining(event.resource);
+                    break;
+                }
+                case SimEventType::MINED:
+                {
+                    log.mineSuccess(event.object, event.rarity);
+                    break;
+                }
+                case SimEventType::INVENTORY_FULL:
+                {
+                    log.inventoryFull();
+                    break;
+                }
+            }
+        }
+        simulation.clearEvents();
+    }
+
+    public:
+        SimThread(){}
+
+        SimThread(const SimThread&) = delete;
+        SimThread& operator=(const SimThread&) = delete;
+
+        ~SimThread()
+        {
+            stop();
+        }
+
+        //the calls below are for the render thread
+        void start()
+        {
+            if(worker.joinable())
+                return;
+            stopping.store(false, std::memory_order_relaxed);
+            worker = std::thread([this]{ run(); });
+        }
+
+        //ends the game in progress with a final checkpoint and waits for the pending saves
+        void stop()
+        {
+            if(!worker.joinable())
+                return;
+            stopping.store(true, std::memory_order_release);
+            wake.release();
+            worker.join();
+        }
+
+        //returns the command's number, compare it with FrameSnapshot::handled_commands to know it was applied,
+        //or 0 if the queue was full and the command dropped
+        std::uint64_t send(SimCommand command)
+        {
+            if(!commands.push(command))
+            {
+                std::cerr<<"Simulation command queue is full, input dropped\n";
+                return 0;
+            }
+            wake.release();
+            return ++sent_commands;
+        }
+
+        //replaces the content between two ticks, content sent before an earlier one was applied supersedes it
+        std::uint64_t setContent(std::shared_ptr<const Content> content)
+        {
+            {
+                std::lock_guard<std::mutex> lock(content_mutex);
+                pending_content = std::move(content);
+            }
+            return send({SimCommandType::SET_CONTENT, 0});
+        }
+
+        //moves to the latest published snapshot, false if nothing new was published since the last call
+        bool acquire() noexcept
+        {
+            return snapshots.acquire();
+        }
+
+        const FrameSnapshot& snapshot() const noexcept
+        {
+            return snapshots.readBuffer();
+        }
+};
+
+#endif
@@ -0,0 +1,367 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+//headless game core: player state, resources, drop resolution and the tick loop
+//frontends drive it through startMining/tick and read back the events it emits
+
+#include "game_data.h"
+#include "content.h"
+#include "player.h"
+#include "random.h"
+#include "offline_progress.h"
+#include "save_file.h"
+#include "journal.h"
+#include "profiler.h"
+
+enum class SimEventType
+{
+    STARTED_MINING,
+    MINED,
+    INVENTORY_FULL
+};
+
+struct SimEvent
+{
+    SimEventType type;
+    ResourceId resource;
+    ObjectId object; //MINED only
+    Rarity rarity;
+};
+
+class Simulation
+{
+    Player player;
+    std::shared_ptr<const Content> content = Content::defaults();
+    std::optional<ResourceId> player_resource_target;
+    std::vector<SimEvent> events;
+    //reused every tick so the mining hot path does not allocate once warmed up
+    std::vector<DropResult> drops;
+    RngService rng;
+    //ticks left until the next tick on which the target drops something, 0 when not sampled yet
+    std::uint64_t ticks_to_drop = 0;
+    //every state change is recorded here when attached, see Game for the checkpoint cycle
+    Journal *journal = nullptr;
+
+    void record(JournalOp op, std::uint16_t value = 0, size_t slot = 0)
+    {
+        if(journal)
+            journal->record(op, value, static_cast<std::uint32_t>(slot));
+    }
+
+    void setAction(PlayerState action)
+    {
+        if(action == IDLE)
+            player.stopAction();
+        else
+            player.startAction(action);
+        record(JournalOp::ACTION, static_cast<std::uint16_t>(action));
+    }
+
+    void recordDrops(const std::vector<DropResult>& added)
+    {
+        for(const DropResult& drop : added)
+            record(JournalOp::ITEM_ADDED, static_cast<std::uint16_t>(drop.object), drop.slot);
+    }
+
+    public:
+        explicit Simulation(size_t inventory_size = INVENTORY_SIZE) : player(inventory_size)
+        {}
+
+        void reset()
+        {
+            player.reset();
+            stopExtraction();
+            events.clear();
+            record(JournalOp::RESET);
+        }
+
+        //starts the random sequences over, a game replays bit for bit from the same seed and inputs
+        void seed(std::uint64_t seed) noexcept
+        {
+            rng.reseed(seed);
+        }
+
+        std::uint64_t getSeed() const noexcept
+        {
+            return rng.getSeed();
+        }
+
+        void attachJournal(Journal *journal) noexcept
+        {
+            this->journal = journal;
+        }
+
+        const Player& getPlayer() const noexcept
+        {
+            return player;
+        }
+
+        const Content& getContent() const noexcept
+        {
+            return *content;
+        }
+
+        //swaps in reloaded content: items and the target move to the ids their keys have now, items whose key
+        //is gone are dropped and mining stops if the target's is; not journaled, the caller checkpoints instead
+        //returns the mapping for whatever else holds ids of the old content
+        IdMap setContent(std::shared_ptr<const Content> replacement)
+        {
+            IdMap ids = replacement->mapFrom(*content);
+            content = std::move(replacement);
+            const Inventory& inventory = player.getInventory();
+            std::vector<std::optional<ObjectId>> items(inventory.size());
+            for(size_t i=0; i<items.size(); i++)
+                if(std::optional<ObjectId> item = inventory.at(i))
+                {
+                    items[i] = ids.object(static_cast<std::uint32_t>(*item));
+                    player.removeItemAt(i);
+                }
+            for(size_t i=0; i<items.size(); i++)
+                if(items[i])
+                    player.placeItem(i, *items[i]);
+            if(player_resource_target)
+            {
+                player_resource_target = ids.resource(static_cast<std::uint32_t>(*player_resource_target));
+                if(!player_resource_target)
+                    player.stopAction();
+                //the countdown was drawn from the old drop rates
+                ticks_to_drop = 0;
+            }
+            return ids;
+        }
+
+        bool setPlayerTarget(ResourceId resource)
+        {
+            if(!content->has(resource))
+            {
+                stopExtraction();
+                return false;
+            }
+            player_resource_target = resource;
+            ticks_to_drop = 0;
+            record(JournalOp::TARGET, static_cast<std::uint16_t>(resource));
+            return true;
+        }
+
+        std::optional<ResourceId> getPlayerTarget() const noexcept
+        {
+            return player_resource_target;
+        }
+
+        void startMining(ResourceId resource)
+        {
+            if(!setPlayerTarget(resource))
+                return;
+            setAction(MINING);
+            events.push_back({SimEventType::STARTED_MINING, resource, ObjectId{}, ALWAYS});
+        }
+
+        const std::vector<DropResult>& extractResource()
+        //Extracts resource and adds it to inventory, returns the drops to tick for verbose
+        {
+            drops.clear();
+            if(!player_resource_target)
+                return drops;
+            //O(1) per tick whatever the size of the drop table, see drop_sampler.h
+            const DropSampler& sampler = content->sampler(*player_resource_target);
+            Rng& drop_rng = rng.stream(RngStream::DROPS);
+            if(ticks_to_drop == 0)
+                ticks_to_drop = sampler.ticksToNextDrop(drop_rng, std::numeric_limits<std::uint64_t>::max());
+            if(--ticks_to_drop > 0)
+                return drops;
+            ResourceDrops table = content->drops(*player_resource_target);
+            sampler.sampleDropTick(drop_rng, [this, &table](size_t i)
+            {
+                if(std::optional<size_t> slot = player.addItem(table.objects[i]))
+                    drops.push_back({table.objects[i], table.rarities[i], *slot});
+                return true;
+            });
+            recordDrops(drops);
+            return drops;
+        }
+
+        void stopExtraction()
+        {
+            player_resource_target.reset();
+            ticks_to_drop = 0;
+            record(JournalOp::TARGET, NO_TARGET);
+        }
+
+        //advances the game by one TICK
+        void tick()
+        {
+            switch(player.getAction())
+            {
+                case IDLE:
+                {
+                    break;
+                }
+                case MINING:
+                {
+                    if(player_resource_target)
+                    {
+                        ResourceId resource = *player_resource_target;
+                        const std::vector<DropResult>& drop = extractResource();
+                        if(drop.empty() && player.isInventoryFull())
+                        {
+                            events.push_back({SimEventType::INVENTORY_FULL, resource, ObjectId{}, ALWAYS});
+                            stopExtraction();
+                            setAction(IDLE);
+                            return;
+                        }
+                        for(size_t i=0; i<drop.size(); i++)
+                            events.push_back({SimEventType::MINED, resource, drop[i].object, drop[i].rarity});
+                    }
+                    break;
+                }
+            }
+        }
+
+        //same outcome distribution as calling tick() the given number of times, but in time
+        //proportional to the items gained, used to credit downtime
+        void fastForward(std::uint64_t ticks)
+        {
+            PROFILE_ZONE("Simulation::fastForward");
+            if(player.getAction() != MINING || !player_resource_target)
+                return;
+            ResourceId resource = *player_resource_target;
+            OfflineProgress progress = resolve_offline_ticks(content->drops(resource), content->sampler(resource), player, ticks, rng.stream(RngStream::DROPS));
+            //the countdown was drawn for ticks that have now been resolved, waits are memoryless so redraw it
+            ticks_to_drop = 0;
+            recordDrops(progress.drops);
+            for(const DropResult& drop : progress.drops)
+                events.push_back({SimEventType::MINED, resource, drop.object, drop.rarity});
+            if(progress.inventory_full)
+            {
+                events.push_back({SimEventType::INVENTORY_FULL, resource, ObjectId{}, ALWAYS});
+                stopExtraction();
+                setAction(IDLE);
+            }
+        }
+
+        //keys section, see Content::writeKeys
+        //player section: action, target, inventory capacity and a u16 object id per slot (NO_CONTENT_ID when empty),
+        //before version 3 slots were one byte each with 0xFF for empty
+        void writeSave(SaveWriter& writer) const
+        {
+            content->writeKeys(writer);
+
+            const Inventory& inventory = player.getInventory();
+            writer.beginSection(SAVE_TAG_PLAYER);
+            writer.put8(static_cast<std::uint8_t>(player.getAction()));
+            writer.put8(player_resource_target ? 1 : 0);
+            writer.put32(player_resource_target ? static_cast<std::uint32_t>(*player_resource_target) : 0);
+            writer.put32(static_cast<std::uint32_t>(inventory.size()));
+            for(size_t i=0; i<inventory.size(); i++)
+            {
+                std::optional<ObjectId> item = inventory.at(i);
+                writer.put16(item ? static_cast<std::uint16_t>(*item) : NO_CONTENT_ID);
+            }
+            writer.endSection();
+
+            //rng section: seed, stream count, then the four state words of every stream
+            writer.beginSection(SAVE_TAG_RNG);
+            writer.put64(rng.getSeed());
+            writer.put32(static_cast<std::uint32_t>(RNG_STREAM_COUNT));
+            for(size_t i=0; i<RNG_STREAM_COUNT; i++)
+                for(std::uint64_t word : rng.stream(static_cast<RngStream>(i)).getState())
+                    writer.put64(word);
+            writer.endSection();
+        }
+
+        //ids is content().readKeys(reader), objects and resources this content no longer has are left out
+        bool readSave(const SaveReader& reader, const IdMap& ids)
+        {
+            reset();
+            std::optional<ByteReader> section = reader.section(SAVE_TAG_PLAYER);
+            if(!section)
+                return false;
+            std::uint8_t action = section->get8();
+            bool has_target = section->get8() != 0;
+            std::uint32_t target = section->get32();
+            std::uint32_t capacity = section->get32();
+            size_t slot_size = reader.getVersion() >= 3 ? 2 : 1;
+            std::string_view slots = section->getBytes(static_cast<size_t>(capacity) * slot_size);
+            if(!section->ok)
+                return false;
+
+            //slots beyond this inventory's size, if it shrank since, go to the first free slot instead
+            ByteReader slot_reader{reinterpret_cast<const std::uint8_t*>(slots.data()), slots.size()};
+            for(size_t i=0; i<capacity; i++)
+            {
+                std::uint32_t saved = slot_size == 2 ? slot_reader.get16() : slot_reader.get8();
+                std::optional<ObjectId> item = ids.object(saved);
+                if(!item)
+                    continue;
+                if(!player.placeItem(i, *item))
+                    player.addItem(*item);
+            }
+            std::optional<ResourceId> resource = ids.resource(target);
+            if(has_target && resource && setPlayerTarget(*resource) && action == static_cast<std::uint8_t>(MINING))
+                player.startAction(MINING);
+
+            //saves from before version 2 have no rng section and keep whatever sequence is running;
+            //streams added since the save was written start from the saved seed
+            if(std::optional<ByteReader> rng_section = reader.section(SAVE_TAG_RNG))
+            {
+                rng.reseed(rng_section->get64());
+                std::uint32_t stream_count = rng_section->get32();
+                for(std::uint32_t i=0; i<stream_count && rng_section->ok; i++)
+                {
+                    std::array<std::uint64_t, 4> state;
+                    for(std::uint64_t& word : state)
+                        word = rng_section->get64();
+                    if(rng_section->ok && i < RNG_STREAM_COUNT)
+                        rng.stream(static_cast<RngStream>(i)).setState(state);
+                }
+            }
+            return true;
+        }
+
+        //applies the records of a journal that follows the snapshot this simulation was loaded from, ids being
+        //the snapshot's, returns how many records were applied; the journal should be detached so replay is not
+        //recorded again
+        size_t replayJournal(JournalReader& reader, const IdMap& ids)
+        {
+            size_t applied = 0;
+            JournalRecord entry;
+            while(reader.next(entry))
+            {
+                switch(entry.op)
+                {
+                    case JournalOp::RESET:
+                        reset();
+                        break;
+                    case JournalOp::ITEM_ADDED:
+                        if(std::optional<ObjectId> item = ids.object(entry.value); item && !player.placeItem(entry.slot, *item))
+                            player.addItem(*item);
+                        break;
+                    case JournalOp::ACTION:
+                        setAction(entry.value == static_cast<std::uint16_t>(MINING) ? MINING : IDLE);
+                        break;
+                    case JournalOp::TARGET:
+                    {
+                        std::optional<ResourceId> resource = ids.resource(entry.value);
+                        if(!resource || !setPlayerTarget(*resource))
+                            stopExtraction();
+                        break;
+                    }
+                }
+                applied++;
+            }
+            events.clear();
+            return applied;
+        }
+
+        const std::vector<SimEvent>& getEvents() const noexcept
+        {
+            return events;
+        }
+
+        void clearEvents() noexcept
+        {
+            events.clear();
+        }
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef SPRITE_REGISTRY_H
+#define SPRITE_REGISTRY_H
+
+#include "game_data.h"
+
+//sprite paths by SpriteID, ids are handed out in the order paths are first registered: the content's sprites
+//(see Content::assignSprites), then any other sprite found on disk or in the asset bundle
+//the atlas rect for each id is filled in later once a renderer exists
+std::vector<std::string>& sprite_registry()
+{
+    static std::vector<std::string> registry;
+    return registry;
+}
+
+//the render thread registers sprites, one lookup per path however many there are
+SpriteID register_sprite(const std::string& path)
+{
+    static std::unordered_map<std::string, SpriteID> ids;
+    std::vector<std::string>& registry = sprite_registry();
+    auto [it, added] = ids.emplace(path, registry.size());
+    if(added)
+        registry.push_back(path);
+    return it->second;
+}
+
+#endif
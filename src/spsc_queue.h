@@ -0,0 +1,50 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+//bounded lock-free queue from one producer thread to one consumer thread
+//the indices only grow and are masked into the ring, each lives on its own cache line and is written by one side only
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+template<typename T, size_t N>
+class SpscQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "the ring index is masked, keep it a power of two");
+
+    std::array<T, N> ring{};
+    alignas(64) std::atomic<size_t> head{0}; //next to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail{0}; //next to push, written by the producer
+
+    public:
+        SpscQueue(){}
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        //producer: false when the queue is full
+        bool push(const T& value) noexcept
+        {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if(t - head.load(std::memory_order_acquire) == N)
+                return false;
+            ring[t & (N - 1)] = value;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        //consumer
+        std::optional<T> pop() noexcept
+        {
+            size_t h = head.load(std::memory_order_relaxed);
+            if(h == tail.load(std::memory_order_acquire))
+                return std::nullopt;
+            T value = ring[h & (N - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return value;
+        }
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include "constants.h"
+
+struct CachedText
+{
+    SDL_Texture *texture;
+    int w;
+    int h;
+};
+
+//keys point into the lru list nodes, which never move, so lookups need no allocation
+struct TextKey
+{
+    std::string_view text;
+    Uint32 color;
+
+    bool operator==(const TextKey& other) const noexcept
+    {
+        return color == other.color && text == other.text;
+    }
+};
+
+struct TextKeyHash
+{
+    size_t operator()(const TextKey& key) const noexcept
+    {
+        return std::hash<std::string_view>{}(key.text) ^ (static_cast<size_t>(key.color) * 0x9E3779B97F4A7C15ull);
+    }
+};
+
+class TextCache
+{
+    struct Entry
+    {
+        CachedText text;
+        std::list<std::pair<std::string, Uint32>>::iterator lru_pos;
+    };
+
+    SDL_Renderer *renderer = nullptr;
+    TTF_Font *font = nullptr;
+    int space_width = 0;
+    //horizontal advance of every ASCII glyph, so laying out a word needs no TTF call
+    std::array<int, GLYPH_ADVANCE_COUNT> advances{};
+    //most recently used at the front
+    std::list<std::pair<std::string, Uint32>> lru;
+    std::unordered_map<TextKey, Entry, TextKeyHash> entries;
+
+    void evict()
+    {
+        while(entries.size() > TEXT_CACHE_CAPACITY)
+        {
+            auto& oldest = lru.back();
+            auto it = entries.find(TextKey{oldest.first, oldest.second});
+            SDL_DestroyTexture(it->second.text.texture);
+            entries.erase(it);
+            lru.pop_back();
+        }
+    }
+
+    public:
+        TextCache(){}
+
+        TextCache(const TextCache&) = delete;
+        TextCache& operator=(const TextCache&) = delete;
+
+        ~TextCache()
+        {
+            clear();
+        }
+
+        void bind(SDL_Renderer *renderer, TTF_Font *font)
+        {
+            clear();
+            this->renderer = renderer;
+            this->font = font;
+            int h = 0;
+            TTF_GetStringSize(font, " ", 1, &space_width, &h);
+            for(size_t c=0; c<GLYPH_ADVANCE_COUNT; c++)
+            {
+                int advance = 0;
+                advances[c] = TTF_GetGlyphMetrics(font, static_cast<Uint32>(c), nullptr, nullptr, nullptr, nullptr, &advance) ? advance : 0;
+            }
+        }
+
+        int getSpaceWidth() const noexcept
+        {
+            return space_width;
+        }
+
+        //width of text as the sum of its glyph advances, kerning is left out (the font is monospaced)
+        int measure(std::string_view text) const
+        {
+            int width = 0;
+            for(char c : text)
+            {
+                unsigned char glyph = static_cast<unsigned char>(c);
+                if(glyph >= GLYPH_ADVANCE_COUNT)
+                {
+                    int h = 0;
+                    TTF_GetStringSize(font, text.data(), text.size(), &width, &h);
+                    return width;
+                }
+                width += advances[glyph];
+            }
+            return width;
+        }
+
+        //rasterizes on a miss, later calls with the same text and color are a hash lookup
+        const CachedText& get(std::string_view text, SDL_Color color)
+        {
+            Uint32 packed = pack_color(color);
+            auto it = entries.find(TextKey{text, packed});
+            if(it != entries.end())
+            {
+                lru.splice(lru.begin(), lru, it->second.lru_pos);
+                return it->second.text;
+            }
+
+            CachedText cached{nullptr, 0, 0};
+            SDL_Surface *surface = TTF_RenderText_Blended(font, text.data(), text.size(), color);
+            if(surface)
+            {
+                cached.texture = SDL_CreateTextureFromSurface(renderer, surface);
+                PROFILE_COUNT(TEXTURE_UPLOADS, 1);
+                cached.w = surface->w;
+                cached.h = surface->h;
+                SDL_DestroySurface(surface);
+            }
+            lru.emplace_front(std::string(text), packed);
+            auto inserted = entries.emplace(TextKey{lru.front().first, packed}, Entry{cached, lru.begin()}).first;
+            //inserted entry is at the front of the lru so eviction cannot remove it
+            evict();
+            return inserted->second.text;
+        }
+
+        void draw(std::string_view text, SDL_Color color, float x, float y)
+        {
+            const CachedText& cached = get(text, color);
+            if(!cached.texture)
+                return;
+            SDL_FRect dst {x, y, static_cast<float>(cached.w), static_cast<float>(cached.h)};
+            SDL_RenderTexture(renderer, cached.texture, nullptr, &dst);
+            PROFILE_COUNT(DRAW_CALLS, 1);
+        }
+
+        void clear() noexcept
+        {
+            for(auto& [key, entry] : entries)
+                if(entry.text.texture)
+                    SDL_DestroyTexture(entry.text.texture);
+            entries.clear();
+            lru.clear();
+        }
+};
+
+#endif
@@ -2,118 +2,186 @@
 #define TEXT_SCREEN_H
 
 #include "screen.h"
+#include "text_cache.h"
+#include "message_log.h"
 
-struct Word
+//a word of a laid out line, its text is chars[offset, offset + length) of the line
+struct LaidWord
 {
-    const std::string text;
-    const SDL_Color color;
-    const float pos_x;
-    float pos_y;
-    const size_t width;
-
-    explicit Word(std::string text, SDL_Color color, float x, float y, size_t width) :
-    text(std::move(text)),
-    color(color),
-    pos_x(x),
-    pos_y(y),
-    width(width)
-    {}
+    std::uint16_t offset;
+    std::uint16_t length;
+    float x;
+    SDL_Color color;
 };
 
+//one line on screen, wrapped and positioned once when its message arrives
+struct LaidLine
+{
+    std::array<char, TEXT_LINE_MAX_CHARS> chars;
+    std::array<LaidWord, TEXT_LINE_MAX_WORDS> words;
+    size_t char_count = 0;
+    size_t word_count = 0;
+
+    std::string_view word(size_t i) const noexcept
+    {
+        return std::string_view(chars.data() + words[i].offset, words[i].length);
+    }
+};
+
+//messages laid out into a fixed ring of SCROLLBACK_LINES lines; a line's place on screen follows from how far it
+//is from the newest one, so a new message writes only its own lines and moves nothing
 class TextScreen : public Screen
 {
-    std::deque<std::vector<Word>> text_buffer;
+    std::vector<LaidLine> lines = std::vector<LaidLine>(SCROLLBACK_LINES);
+    //lines laid out since the last reset, the newest is at (line_total - 1) % SCROLLBACK_LINES
+    std::uint64_t line_total = 0;
+    //lines scrolled back from the newest, 0 follows new messages
+    size_t scroll = 0;
+    //how far into the message log the layout is
+    std::uint64_t laid_generation = 0;
+    std::uint64_t laid_messages = 0;
+
+    size_t visibleLines() const noexcept
+    {
+        return static_cast<size_t>(getHeight() / FONT_SIZE);
+    }
+
+    size_t heldLines() const noexcept
+    {
+        return static_cast<size_t>(std::min<std::uint64_t>(line_total, SCROLLBACK_LINES));
+    }
+
+    size_t maxScroll() const noexcept
+    {
+        return heldLines() > visibleLines() ? heldLines() - visibleLines() : 0;
+    }
+
+    LaidLine& newLine() noexcept
+    {
+        LaidLine& line = lines[line_total % SCROLLBACK_LINES];
+        line.char_count = 0;
+        line.word_count = 0;
+        line_total++;
+        //a scrolled back view stays on the lines it shows
+        if(scroll > 0)
+            scroll = std::min(scroll + 1, maxScroll());
+        return line;
+    }
 
     public:
         TextScreen(float x, float y, float w, float h) : Screen(x, y, w, h)
         {}
 
-        void clearTextBuffer() noexcept
-        {
-            text_buffer.clear();
-        }
-
-        size_t getTextLen(const std::string& text, TTF_Font *font) const noexcept
+        void clear() noexcept
         {
-            int w, h;
-            w = h = 0;
-            TTF_GetStringSize(font, text.c_str(), text.size(), &w, &h);
-            return static_cast<size_t>(w);
+            line_total = 0;
+            scroll = 0;
+            markDirty();
         }
 
-        void shiftTextUp()
+        //lays out one message from its template, wrapping at the screen's width; a word too wide for the screen
+        //gets a line of its own, characters past TEXT_LINE_MAX_CHARS are cut; names come from content
+        void pushMessage(const LogMessage& message, const TextCache& text_cache, const Content& content) noexcept
         {
-            for (auto& line : text_buffer)
-                for (auto& word : line)
-                    word.pos_y -= FONT_SIZE;
-        }
-
-        void makeSpaceTextBuffer()
-        {
-            if(text_buffer.size() == NUM_LINES)
-                text_buffer.pop_front();
-            shiftTextUp();
-        }
-
-        void pushTextToTextBuffer(const std::vector<std::string>& words, const std::vector<SDL_Color>& colors, TTF_Font *font)
-        {
-            makeSpaceTextBuffer();
-            text_buffer.emplace_back();
-            const size_t space_size = getTextLen(" ", font);
-            size_t buffer_counter = 0;
-            for (size_t i = 0; i < words.size(); i++)
+            const MessageTemplate& message_template = MESSAGE_TEMPLATES[static_cast<size_t>(message.id)];
+            const float space = static_cast<float>(text_cache.getSpaceWidth());
+            LaidLine *line = &newLine();
+            float x = 0.0f;
+            for(size_t i=0; i<message_template.len; i++)
             {
-                size_t w = getTextLen(words[i], font);
-                if(buffer_counter + w <= static_cast<size_t>(getWidth()))
+                const TemplateWord& word = message_template.words[i];
+                std::string_view name;
+                SDL_Color color = word.color;
+                switch(word.kind)
                 {
-                    float x = static_cast<float>(buffer_counter);
-                    float y = getY() + getHeight() - FONT_SIZE;
-                    text_buffer.back().emplace_back(words[i], colors[i], x, y, w);
-                    buffer_counter += w + space_size;
+                    case TemplateWordKind::TEXT:
+                        break;
+                    case TemplateWordKind::RESOURCE:
+                    {
+                        ResourceId resource = static_cast<ResourceId>(message.arg);
+                        if(content.has(resource))
+                            name = content.name(resource);
+                        break;
+                    }
+                    case TemplateWordKind::OBJECT:
+                    {
+                        ObjectId object = static_cast<ObjectId>(message.arg);
+                        if(content.has(object))
+                            name = content.name(object);
+                        color = rarity_to_color(message.rarity);
+                        break;
+                    }
                 }
-                else
+                size_t length = std::min(name.size() + word.text.size(), TEXT_LINE_MAX_CHARS);
+                float width = static_cast<float>(text_cache.measure(name) + text_cache.measure(word.text));
+                if(line->word_count > 0 && (x + width > getWidth() || line->word_count == TEXT_LINE_MAX_WORDS ||
+                    line->char_count + length > TEXT_LINE_MAX_CHARS))
                 {
-                    makeSpaceTextBuffer();
-                    text_buffer.emplace_back();
-                    buffer_counter = 0;
-                    i--;
+                    line = &newLine();
+                    x = 0.0f;
                 }
+                size_t offset = line->char_count;
+                size_t name_length = std::min(name.size(), length);
+                std::copy_n(name.data(), name_length, line->chars.data() + offset);
+                std::copy_n(word.text.data(), length - name_length, line->chars.data() + offset + name_length);
+                line->char_count += length;
+                line->words[line->word_count++] = {static_cast<std::uint16_t>(offset), static_cast<std::uint16_t>(length), getX() + x, color};
+                x += width + space;
             }
         }
 
-        void drawText(const std::string& text, const float& x, const float& y, size_t w, SDL_Renderer *renderer,
-            TTF_Font *font, const SDL_Color& color = WHITE, const float& h = FONT_SIZE) const
+        //lays out the messages that arrived since the last call, all of them again if the log was cleared
+        void update(const MessageLog& log, const TextCache& text_cache, const Content& content) noexcept
         {
-            SDL_Surface* text_surface = TTF_RenderText_Blended(font, text.c_str(), text.size(), color);
-            SDL_Texture* text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-            SDL_DestroySurface(text_surface);
-            SDL_FRect dst {x, y, static_cast<float>(w), h};
-            SDL_RenderTexture(renderer, text_texture, nullptr, &dst);
-            SDL_DestroyTexture(text_texture);
-        }
-
-        void render(SDL_Renderer *renderer, TTF_Font *font) const
-        {
-            renderBox(renderer);
-            for(const std::vector<Word>& word_line : text_buffer)
-                for(const Word& word : word_line)
-                    drawText(word.text, word.pos_x, word.pos_y, word.width, renderer, font, word.color);
+            if(log.getGeneration() != laid_generation || log.getTotal() < laid_messages)
+            {
+                clear();
+                laid_generation = log.getGeneration();
+                laid_messages = 0;
+            }
+            //messages that dropped out of the log's history before they were laid out are skipped
+            laid_messages = std::max(laid_messages, log.getTotal() - log.size());
+            if(laid_messages == log.getTotal())
+                return;
+            for(; laid_messages < log.getTotal(); laid_messages++)
+                pushMessage(log.message(laid_messages), text_cache, content);
+            markDirty();
         }
 
-        void startedMining(const std::string& res_name, TTF_Font *font)
+        //positive goes back in the history, negative towards the newest line
+        void scrollBy(int delta) noexcept
         {
-            pushTextToTextBuffer({"You", "started", "to", "mine", res_name+"."}, {WHITE, WHITE, WHITE, WHITE, WHITE}, font);
+            long target = static_cast<long>(scroll) + delta;
+            size_t scrolled = static_cast<size_t>(std::clamp(target, 0l, static_cast<long>(maxScroll())));
+            if(scrolled != scroll)
+                markDirty();
+            scroll = scrolled;
         }
 
-        void mineSuccess(const std::string& obj_name, SDL_Color rarity_color, TTF_Font *font)
+        void scrollPage(int pages) noexcept
         {
-            pushTextToTextBuffer({"You", "mined", "a", obj_name+"."}, {WHITE, WHITE, WHITE, rarity_color}, font);
+            scrollBy(pages * static_cast<int>(visibleLines()));
         }
 
-        void inventoryFull(TTF_Font *font)
+        void render(SDL_Renderer *renderer, TextCache& text_cache)
         {
-            pushTextToTextBuffer({"Your", "inventory", "is", "full!"}, {WHITE, WHITE, WHITE, WHITE}, font);
+            PROFILE_ZONE("TextScreen::render");
+            if(beginCache(renderer))
+            {
+                renderBox(renderer);
+                //row 0 is the bottom row, which shows the newest line when not scrolled back
+                size_t rows = std::min(visibleLines(), heldLines() - std::min(scroll, heldLines()));
+                for(size_t row=0; row<rows; row++)
+                {
+                    const LaidLine& line = lines[(line_total - 1 - scroll - row) % SCROLLBACK_LINES];
+                    float y = getY() + getHeight() - FONT_SIZE * static_cast<float>(row + 1);
+                    for(size_t i=0; i<line.word_count; i++)
+                        text_cache.draw(line.word(i), line.words[i].color, line.words[i].x, y);
+                }
+                endCache(renderer);
+            }
+            blitCache(renderer);
         }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,161 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include "constants.h"
+#include "sprite_registry.h"
+#include "grid_mesh.h"
+
+class TextureManager
+{
+    SDL_Texture *atlas = nullptr;
+    std::vector<SDL_FRect> sprite_rects;
+    //sprites reloaded since the atlas was built get a texture of their own, by SpriteID
+    std::vector<SDL_Texture*> replaced;
+    float atlas_width = 0.0f;
+    float atlas_height = 0.0f;
+    //bumped whenever a sprite may look different, meshes built from the atlas compare it with theirs
+    std::uint64_t generation = 0;
+
+    public:
+        TextureManager(){}
+
+        TextureManager(const TextureManager&) = delete;
+        TextureManager& operator=(const TextureManager&) = delete;
+
+        ~TextureManager()
+        {
+            destroy();
+        }
+
+        //packs the sprites, by SpriteID as AssetLoader hands them over, into one texture; null surfaces are left out
+        bool buildAtlas(SDL_Renderer *renderer, const std::vector<SDL_Surface*>& surfaces)
+        {
+            destroy();
+            //shelf packing, tallest sprites first so each shelf wastes as little height as possible
+            std::vector<size_t> order(surfaces.size());
+            for(size_t i=0; i<order.size(); i++)
+                order[i] = i;
+            std::sort(order.begin(), order.end(), [&surfaces](size_t a, size_t b)
+            {
+                int ha = surfaces[a] ? surfaces[a]->h : 0;
+                int hb = surfaces[b] ? surfaces[b]->h : 0;
+                return ha > hb;
+            });
+
+            sprite_rects.assign(surfaces.size(), SDL_FRect{0.0f, 0.0f, 0.0f, 0.0f});
+            int shelf_x = static_cast<int>(ATLAS_PADDING);
+            int shelf_y = static_cast<int>(ATLAS_PADDING);
+            int shelf_h = 0;
+            for(size_t i : order)
+            {
+                if(!surfaces[i])
+                    continue;
+                if(shelf_x + surfaces[i]->w + static_cast<int>(ATLAS_PADDING) > static_cast<int>(ATLAS_WIDTH))
+                {
+                    shelf_x = static_cast<int>(ATLAS_PADDING);
+                    shelf_y += shelf_h + static_cast<int>(ATLAS_PADDING);
+                    shelf_h = 0;
+                }
+                sprite_rects[i] = {static_cast<float>(shelf_x), static_cast<float>(shelf_y), static_cast<float>(surfaces[i]->w), static_cast<float>(surfaces[i]->h)};
+                shelf_x += surfaces[i]->w + static_cast<int>(ATLAS_PADDING);
+                shelf_h = std::max(shelf_h, surfaces[i]->h);
+            }
+            int atlas_height_px = shelf_y + shelf_h + static_cast<int>(ATLAS_PADDING);
+
+            SDL_Surface *atlas_surface = SDL_CreateSurface(static_cast<int>(ATLAS_WIDTH), atlas_height_px, SDL_PIXELFORMAT_RGBA32);
+            if(atlas_surface)
+            {
+                SDL_ClearSurface(atlas_surface, 0.0f, 0.0f, 0.0f, 0.0f);
+                for(size_t i=0; i<surfaces.size(); i++)
+                {
+                    if(!surfaces[i])
+                        continue;
+                    SDL_Rect dst = {static_cast<int>(sprite_rects[i].x), static_cast<int>(sprite_rects[i].y), surfaces[i]->w, surfaces[i]->h};
+                    SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+                    SDL_BlitSurface(surfaces[i], nullptr, atlas_surface, &dst);
+                }
+                atlas = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+                PROFILE_COUNT(TEXTURE_UPLOADS, 1);
+                SDL_DestroySurface(atlas_surface);
+            }
+
+            if(!atlas)
+                return false;
+            atlas_width = static_cast<float>(ATLAS_WIDTH);
+            atlas_height = static_cast<float>(atlas_height_px);
+            SDL_SetTextureScaleMode(atlas, SDL_SCALEMODE_NEAREST);
+            return true;
+        }
+
+        //swaps in a new image for a sprite, also one the atlas does not have
+        bool replaceSprite(SDL_Renderer *renderer, SpriteID sprite, SDL_Surface *surface)
+        {
+            SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+            if(!texture)
+                return false;
+            PROFILE_COUNT(TEXTURE_UPLOADS, 1);
+            SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+            if(sprite >= replaced.size())
+                replaced.resize(sprite + 1, nullptr);
+            if(replaced[sprite])
+                SDL_DestroyTexture(replaced[sprite]);
+            replaced[sprite] = texture;
+            generation++;
+            return true;
+        }
+
+        bool hasSprite(SpriteID sprite) const noexcept
+        {
+            return (sprite < replaced.size() && replaced[sprite]) || (sprite < sprite_rects.size() && sprite_rects[sprite].w != 0.0f);
+        }
+
+        SDL_Texture *getAtlas() const noexcept
+        {
+            return atlas;
+        }
+
+        std::uint64_t getGeneration() const noexcept
+        {
+            return generation;
+        }
+
+        //adds a quad drawing the sprite from the atlas to a mesh drawn with getAtlas(); false if the atlas does not
+        //hold it, a reloaded sprite is then drawn on its own with renderSprite
+        bool addSprite(GridMesh& mesh, SpriteID sprite, const SDL_FRect& dst) const
+        {
+            if((sprite < replaced.size() && replaced[sprite]) || sprite >= sprite_rects.size() || sprite_rects[sprite].w == 0.0f)
+                return false;
+            const SDL_FRect& rect = sprite_rects[sprite];
+            mesh.addQuad(dst, WHITE, {rect.x / atlas_width, rect.y / atlas_height, rect.w / atlas_width, rect.h / atlas_height});
+            return true;
+        }
+
+        void renderSprite(SDL_Renderer *renderer, SpriteID sprite, const SDL_FRect *dst) const
+        {
+            if(sprite < replaced.size() && replaced[sprite])
+            {
+                SDL_RenderTexture(renderer, replaced[sprite], nullptr, dst);
+                PROFILE_COUNT(DRAW_CALLS, 1);
+                return;
+            }
+            if(sprite >= sprite_rects.size() || sprite_rects[sprite].w == 0.0f)
+                return;
+            SDL_RenderTexture(renderer, atlas, &sprite_rects[sprite], dst);
+            PROFILE_COUNT(DRAW_CALLS, 1);
+        }
+
+        void destroy() noexcept
+        {
+            if(atlas)
+                SDL_DestroyTexture(atlas);
+            atlas = nullptr;
+            sprite_rects.clear();
+            for(SDL_Texture *texture : replaced)
+                if(texture)
+                    SDL_DestroyTexture(texture);
+            replaced.clear();
+            generation++;
+        }
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+//lock-free handoff of the latest value from one producer thread to one consumer thread
+//the producer fills its back slot and publishes it by swapping it with the middle slot, the consumer takes the
+//middle slot in exchange for its front slot when it is newer; neither side ever waits on the other, the consumer
+//always reads a whole value and values the consumer was too slow to see are simply overwritten
+//slots are reused, so a published value is whatever the producer last wrote into that slot: producers that
+//only copy what changed have to compare against the slot's own contents
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+template<typename T>
+class TripleBuffer
+{
+    //set in middle when it holds a value the consumer has not taken yet
+    static constexpr std::uint8_t FRESH = 4;
+
+    struct alignas(64) Slot
+    {
+        T value{};
+    };
+
+    std::array<Slot, 3> slots;
+    alignas(64) std::atomic<std::uint8_t> middle{1};
+    std::uint8_t back = 0; //producer only
+    std::uint8_t front = 2; //consumer only
+
+    public:
+        TripleBuffer(){}
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        //producer: the slot to fill before publish
+        T& writeBuffer() noexcept
+        {
+            return slots[back].value;
+        }
+
+        void publish() noexcept
+        {
+            back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+        }
+
+        //consumer: moves to the latest published value, returns false if there was none since the last call
+        bool acquire() noexcept
+        {
+            if(!(middle.load(std::memory_order_relaxed) & FRESH))
+                return false;
+            front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+            return true;
+        }
+
+        const T& readBuffer() const noexcept
+        {
+            return slots[front].value;
+        }
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef WORLD_MAP_H
+#define WORLD_MAP_H
+
+//the tiles of the world and the resource node on each, stored in CHUNK_SIZE x CHUNK_SIZE chunks
+//a chunk is generated the first time anything asks for it, from the game's seed and the tile coordinates alone,
+//so the order chunks are visited in never changes the world and a map of millions of tiles only holds the chunks
+//that were looked at; the chunk directory is one pointer per chunk, a tile is found with two divisions
+
+#include "content.h"
+#include "random.h"
+
+constexpr size_t CHUNK_SIZE = 32;
+constexpr size_t CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+//2048 x 2048 tiles
+constexpr size_t WORLD_CHUNKS_X = 64;
+constexpr size_t WORLD_CHUNKS_Y = 64;
+//chance in 1000 that a tile holds a resource node
+constexpr std::uint64_t WORLD_NODES_PER_MILLE = 40;
+//every resource is placed at the spawn, every other tile along rows of this many
+constexpr size_t SPAWN_ROW_NODES = 8;
+
+struct TileCoord
+{
+    size_t x;
+    size_t y;
+
+    bool operator==(const TileCoord&) const = default;
+};
+
+struct WorldChunk
+{
+    //resource id of every tile row by row, NO_CONTENT_ID for bare ground
+    std::array<std::uint16_t, CHUNK_TILES> tiles;
+    //bumped by every change, renderers compare it with what they built from
+    std::uint64_t revision = 0;
+};
+
+class WorldMap
+{
+    size_t chunks_x;
+    size_t chunks_y;
+    std::uint64_t world_seed = 0;
+    std::uint64_t seed_value = 0;
+    size_t resource_count = 0;
+    //null until the chunk is generated
+    std::vector<std::unique_ptr<WorldChunk>> chunks;
+    size_t generated = 0;
+
+    //what generation puts on a tile, a pure function of the seed and the coordinates
+    std::uint16_t generateTile(size_t x, size_t y) const noexcept
+    {
+        if(resource_count == 0)
+            return NO_CONTENT_ID;
+        size_t spawn_x = spawnX();
+        size_t spawn_y = spawnY();
+        if(x >= spawn_x && y >= spawn_y && (x - spawn_x) % 2 == 0 && (y - spawn_y) % 2 == 0)
+        {
+            size_t column = (x - spawn_x) / 2;
+            size_t index = (y - spawn_y) / 2 * SPAWN_ROW_NODES + column;
+            if(column < SPAWN_ROW_NODES && index < resource_count)
+                return static_cast<std::uint16_t>(index);
+        }
+        std::uint64_t state = world_seed ^ (static_cast<std::uint64_t>(y) * tilesX() + x);
+        std::uint64_t hash = splitmix64(state);
+        if(hash % 1000 >= WORLD_NODES_PER_MILLE)
+            return NO_CONTENT_ID;
+        return static_cast<std::uint16_t>((hash >> 32) % resource_count);
+    }
+
+    WorldChunk& generate(size_t cx, size_t cy)
+    {
+        std::unique_ptr<WorldChunk>& chunk = chunks[cy * chunks_x + cx];
+        if(!chunk)
+        {
+            chunk = std::make_unique<WorldChunk>();
+            for(size_t y=0; y<CHUNK_SIZE; y++)
+                for(size_t x=0; x<CHUNK_SIZE; x++)
+                    chunk->tiles[y * CHUNK_SIZE + x] = generateTile(cx * CHUNK_SIZE + x, cy * CHUNK_SIZE + y);
+            generated++;
+        }
+        return *chunk;
+    }
+
+    public:
+        WorldMap(size_t chunks_x = WORLD_CHUNKS_X, size_t chunks_y = WORLD_CHUNKS_Y) :
+            chunks_x(std::max<size_t>(chunks_x, 1)), chunks_y(std::max<size_t>(chunks_y, 1)),
+            chunks(this->chunks_x * this->chunks_y)
+        {
+            reset(DEFAULT_RNG_SEED, 0);
+        }
+
+        //forgets every chunk, the world is generated again from seed with resources [0, resources)
+        void reset(std::uint64_t seed, size_t resources)
+        {
+            seed_value = seed;
+            //the world stream of the game's seed, so the world never draws numbers the drops would
+            world_seed = RngService(seed).stream(RngStream::WORLD).next();
+            resource_count = std::min<size_t>(resources, NO_CONTENT_ID);
+            for(std::unique_ptr<WorldChunk>& chunk : chunks)
+                chunk.reset();
+            generated = 0;
+        }
+
+        //after the content changed: nodes of resources the new content still has get their new ids, the rest
+        //become bare ground, and the spawn block is laid out again in the new ids; chunks generated from now on
+        //use the new resources
+        void remap(const IdMap& ids, size_t resources)
+        {
+            resource_count = std::min<size_t>(resources, NO_CONTENT_ID);
+            for(std::unique_ptr<WorldChunk>& chunk : chunks)
+            {
+                if(!chunk)
+                    continue;
+                for(std::uint16_t& tile : chunk->tiles)
+                    if(tile != NO_CONTENT_ID)
+                    {
+                        std::optional<ResourceId> resource = ids.resource(tile);
+                        tile = resource ? static_cast<std::uint16_t>(*resource) : NO_CONTENT_ID;
+                    }
+                chunk->revision++;
+            }
+            for(size_t i=0; i<resource_count; i++)
+            {
+                TileCoord tile = *spawnTile(static_cast<ResourceId>(i));
+                WorldChunk *chunk = tile.x < tilesX() && tile.y < tilesY() ? chunks[tile.y / CHUNK_SIZE * chunks_x + tile.x / CHUNK_SIZE].get() : nullptr;
+                if(chunk)
+                    chunk->tiles[(tile.y % CHUNK_SIZE) * CHUNK_SIZE + tile.x % CHUNK_SIZE] = static_cast<std::uint16_t>(i);
+            }
+        }
+
+        std::uint64_t getSeed() const noexcept { return seed_value; }
+        size_t chunksX() const noexcept { return chunks_x; }
+        size_t chunksY() const noexcept { return chunks_y; }
+        size_t tilesX() const noexcept { return chunks_x * CHUNK_SIZE; }
+        size_t tilesY() const noexcept { return chunks_y * CHUNK_SIZE; }
+        size_t generatedChunks() const noexcept { return generated; }
+
+        //top left tile of the block of nodes every world starts with, near the middle
+        size_t spawnX() const noexcept { return tilesX() / 2; }
+        size_t spawnY() const noexcept { return tilesY() / 2; }
+
+        //where generation put resource in the spawn block, whatever is on the tile now
+        std::optional<TileCoord> spawnTile(ResourceId resource) const noexcept
+        {
+            size_t index = static_cast<size_t>(resource);
+            if(index >= resource_count)
+                return std::nullopt;
+            return TileCoord{spawnX() + 2 * (index % SPAWN_ROW_NODES), spawnY() + 2 * (index / SPAWN_ROW_NODES)};
+        }
+
+        //generated on first use; cx and cy must be inside the world
+        const WorldChunk& chunk(size_t cx, size_t cy)
+        {
+            return generate(cx, cy);
+        }
+
+        std::optional<ResourceId> resourceAt(size_t x, size_t y)
+        {
+            if(x >= tilesX() || y >= tilesY())
+                return std::nullopt;
+            std::uint16_t tile = generate(x / CHUNK_SIZE, y / CHUNK_SIZE).tiles[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE];
+            if(tile == NO_CONTENT_ID)
+                return std::nullopt;
+            return static_cast<ResourceId>(tile);
+        }
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef TEST_H
+#define TEST_H
+
+//what the test executables share: CHECK reports a failed condition with its line and carries on, main ends with
+//return test_result("name") so ctest sees the failures; statistical checks use fixed seeds, so they either
+//always pass or always fail
+
+#include "content.h"
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+inline int test_failures = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        if(!(condition)) \
+        { \
+            std::cerr<<__FILE__<<":"<<__LINE__<<": check failed: "<<#condition<<"\n"; \
+            test_failures++; \
+        } \
+    } while(0)
+
+int test_result(const char *name)
+{
+    if(test_failures > 0)
+    {
+        std::cerr<<name<<": "<<test_failures<<" checks failed\n";
+        return 1;
+    }
+    std::cout<<name<<": ok\n";
+    return 0;
+}
+
+//a content table parsed from text, the checks cannot go on without it
+std::shared_ptr<const Content> test_content(const std::string& text)
+{
+    std::shared_ptr<const Content> content = Content::parse(text, "test content");
+    if(!content)
+    {
+        std::cerr<<"test content does not parse\n";
+        std::exit(1);
+    }
+    return content;
+}
+
+//an empty directory of the test's own as the working directory until the end of the scope, for tests that write
+//files; also removed when the test leaves through std::exit, as test_content does
+class ScratchDirectory
+{
+    inline static ScratchDirectory *current = nullptr;
+    std::filesystem::path directory;
+    std::filesystem::path previous;
+
+    static void leave_current() noexcept
+    {
+        if(current)
+            current->leave();
+    }
+
+    void leave() noexcept
+    {
+        std::error_code error;
+        std::filesystem::current_path(previous, error);
+        std::filesystem::remove_all(directory, error);
+        current = nullptr;
+    }
+
+    public:
+        explicit ScratchDirectory(std::string_view name) :
+            directory(std::filesystem::temp_directory_path() / ("skillquest_test_" + std::string(name))),
+            previous(std::filesystem::current_path())
+        {
+            static const bool registered = std::atexit(leave_current) == 0;
+            (void)registered;
+            std::filesystem::remove_all(directory);
+            std::filesystem::create_directories(directory);
+            std::filesystem::current_path(directory);
+            current = this;
+        }
+
+        ScratchDirectory(const ScratchDirectory&) = delete;
+        ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+        ~ScratchDirectory()
+        {
+            leave();
+        }
+};
+
+//mean and variance of a sample, for comparing two ways of producing the same distribution
+struct Moments
+{
+    double n = 0.0;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+
+    void add(double x) noexcept
+    {
+        n += 1.0;
+        sum += x;
+        sum_sq += x * x;
+    }
+
+    double mean() const noexcept
+    {
+        return sum / n;
+    }
+
+    double variance() const noexcept
+    {
+        return (sum_sq - sum * sum / n) / (n - 1.0);
+    }
+};
+
+//the two samples' means differ by less than z standard errors
+bool same_mean(const Moments& a, const Moments& b, double z = 5.0)
+{
+    double error = std::sqrt(a.variance() / a.n + b.variance() / b.n);
+    return std::abs(a.mean() - b.mean()) <= z * error + 1e-12;
+}
+
+//Pearson's statistic of observed counts against expected ones, cells expected below 5 are pooled into one
+//returns whether it is below the critical value at significance about 1e-4 (Wilson-Hilferty approximation)
+bool chi_square_fits(const std::vector<double>& observed, const std::vector<double>& expected)
+{
+    double stat = 0.0;
+    double pooled_observed = 0.0;
+    double pooled_expected = 0.0;
+    size_t cells = 0;
+    for(size_t i=0; i<observed.size(); i++)
+    {
+        if(expected[i] < 5.0)
+        {
+            pooled_observed += observed[i];
+            pooled_expected += expected[i];
+            continue;
+        }
+        stat += (observed[i] - expected[i]) * (observed[i] - expected[i]) / expected[i];
+        cells++;
+    }
+    if(pooled_expected > 0.0)
+    {
+        stat += (pooled_observed - pooled_expected) * (pooled_observed - pooled_expected) / std::max(pooled_expected, 1.0);
+        cells++;
+    }
+    if(cells < 2)
+        return true;
+    double df = static_cast<double>(cells - 1);
+    double z = 3.72;
+    double a = 2.0 / (9.0 * df);
+    double critical = df * std::pow(1.0 - a + z * std::sqrt(a), 3.0);
+    if(stat > critical)
+        std::cerr<<"chi-square "<<stat<<" over "<<critical<<" with "<<df<<" degrees of freedom\n";
+    return stat <= critical;
+}
+
+#endif
@@ -0,0 +1,86 @@
+//the mining hot path makes no heap allocation once warmed up: every operator new in this executable is counted
+//and a long mining run, events drained each tick the way the sim thread does, must not add to the count
+
+#include "test.h"
+#include "simulation.h"
+#include <new>
+
+static size_t allocations = 0;
+
+//kept out of line: inlined, GCC sees memory from malloc reach operator delete and warns about a mismatched pair
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    allocations++;
+    if(void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+[[gnu::noinline]] void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+//large enough that the run never fills it
+constexpr size_t INVENTORY = 100000;
+constexpr size_t WARMUP_TICKS = 1000;
+constexpr size_t TICKS = 100000;
+
+int main()
+{
+    std::shared_ptr<const Content> content = test_content(R"(
+object a "a" a.png
+object b "b" b.png
+object c "c" c.png
+object d "d" d.png
+resource ore "ore" ore.png a:2 b:5 c:40 d:1000
+)");
+    const ResourceId ore = *content->findResource("ore");
+
+    Simulation simulation(INVENTORY);
+    simulation.setContent(content);
+    simulation.startMining(ore);
+    //the drop buffer and event list reach the most one tick needs, and every object has been placed once so the
+    //inventory's per object tables are sized
+    for(size_t i=0; i<WARMUP_TICKS; i++)
+    {
+        simulation.tick();
+        simulation.clearEvents();
+    }
+    for(size_t i=0; i<4; i++)
+        CHECK(simulation.getPlayer().getInventory().contains(static_cast<ObjectId>(i)));
+
+    size_t before = allocations;
+    size_t occupancy = simulation.getPlayer().getInventory().getOccupancy();
+    for(size_t i=0; i<TICKS; i++)
+    {
+        simulation.tick();
+        simulation.clearEvents();
+    }
+    CHECK(allocations == before);
+    //the run really mined
+    CHECK(simulation.getPlayer().getInventory().getOccupancy() > occupancy + TICKS / 2);
+    CHECK(simulation.getPlayer().getAction() == MINING);
+
+    return test_result("allocations");
+}
@@ -0,0 +1,61 @@
+//asset bundles hold more entries than a 16 bit count, a loose file saved after the bundle marks its entry as
+//not current, and a bundle of another version is refused
+
+#include "test.h"
+#include "asset_bundle.h"
+
+constexpr size_t FILES = 70000;
+
+std::string file_path(size_t i)
+{
+    return "assets/file_" + std::to_string(i);
+}
+
+int main()
+{
+    //entries' paths are relative to the working directory, as in the game
+    ScratchDirectory scratch("asset_bundle");
+    std::filesystem::create_directories("assets");
+    BundleWriter writer;
+    for(size_t i=0; i<FILES; i++)
+        writer.addFile(file_path(i), {static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i >> 8)});
+    writer.addImage("assets/image.png", 2, 3, std::vector<std::uint8_t>(2 * 3 * 4, 7));
+    const std::vector<std::uint8_t> bytes = writer.finish();
+    CHECK(write_file_atomically(ASSET_BUNDLE_PATH, bytes));
+
+    AssetBundle bundle;
+    CHECK(bundle.open(ASSET_BUNDLE_PATH));
+    CHECK(bundle.getEntries().size() == FILES + 1);
+    size_t mismatches = 0;
+    for(size_t i=0; i<FILES; i++)
+    {
+        const BundleEntry *entry = bundle.find(file_path(i));
+        if(!entry || entry->kind != BundleKind::FILE || entry->size != 2 || entry->data[0] != static_cast<std::uint8_t>(i) ||
+            entry->data[1] != static_cast<std::uint8_t>(i >> 8))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+    const BundleEntry *image = bundle.find("assets/image.png");
+    CHECK(image && image->kind == BundleKind::IMAGE && image->width == 2 && image->height == 3 && image->data[23] == 7);
+    CHECK(bundle.find("assets/missing") == nullptr);
+
+    //a loose copy older than the bundle, one saved after it and none at all
+    std::filesystem::file_time_type packed = std::filesystem::last_write_time(ASSET_BUNDLE_PATH);
+    std::vector<std::uint8_t> loose = {1};
+    CHECK(write_file_atomically(file_path(0), loose));
+    CHECK(write_file_atomically(file_path(1), loose));
+    std::filesystem::last_write_time(file_path(0), packed - std::chrono::hours(1));
+    std::filesystem::last_write_time(file_path(1), packed + std::chrono::hours(1));
+    CHECK(bundle.isCurrent(*bundle.find(file_path(0))));
+    CHECK(!bundle.isCurrent(*bundle.find(file_path(1))));
+    CHECK(bundle.isCurrent(*bundle.find(file_path(2))));
+    bundle.close();
+
+    //a version 1 bundle is ignored, the game then loads the loose files
+    std::vector<std::uint8_t> old = bytes;
+    old[BUNDLE_MAGIC.size()] = 1;
+    old[BUNDLE_MAGIC.size() + 1] = 0;
+    CHECK(write_file_atomically(ASSET_BUNDLE_PATH, old));
+    CHECK(!bundle.open(ASSET_BUNDLE_PATH));
+    return test_result("asset bundle");
+}
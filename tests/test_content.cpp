@@ -0,0 +1,48 @@
+//the content format: quoted tokens may hold spaces or be empty, and every malformed line is rejected with an
+//error instead of parsing into something else; rejected lines are reported on std::cerr as they would be in game
+
+#include "test.h"
+
+constexpr const char *OBJECTS = R"(
+object a "a" a.png
+object b "b" b.png
+)";
+
+bool parses(const std::string& lines)
+{
+    return Content::parse(OBJECTS + lines, "test content") != nullptr;
+}
+
+int main()
+{
+    std::shared_ptr<const Content> content = test_content(std::string(OBJECTS) + R"(
+object c "" c.png   # an empty name is only shown as nothing
+resource r "two words" "r r.png" a:2 b:3
+)");
+    CHECK(content->objectCount() == 3 && content->resourceCount() == 1);
+    CHECK(content->name(ObjectId(2)).empty());
+    ResourceId r = *content->findResource("r");
+    CHECK(content->name(r) == "two words" && content->path(r) == "r r.png");
+    CHECK(content->drops(r).size() == 2);
+
+    //an empty key or sprite, and an empty token among the drops, which must not end the line early
+    CHECK(!parses("object \"\" \"empty\" e.png\n"));
+    CHECK(!parses("object e \"empty\" \"\"\n"));
+    CHECK(!parses("resource \"\" \"r\" r.png a:2\n"));
+    CHECK(!parses("resource r \"r\" \"\" a:2\n"));
+    CHECK(!parses("resource r \"r\" r.png a:2 \"\" b:3\n"));
+    CHECK(!parses("resource r \"r\" r.png \"\"\n"));
+    //the other ways a line goes wrong
+    CHECK(!parses("\"\" a \"a\" a.png\n"));
+    CHECK(!parses("\"object\n"));
+    CHECK(!parses("object e \"empty e.png\n"));
+    CHECK(!parses("object e \"e\" e.png extra\n"));
+    CHECK(!parses("object a \"a\" a.png\n"));
+    CHECK(!parses("resource r \"r\" r.png\n"));
+    CHECK(!parses("resource r \"r\" r.png c:2\n"));
+    CHECK(!parses("resource r \"r\" r.png a:0\n"));
+    CHECK(!parses("resource r \"r\" r.png a:2 a:3\n"));
+    CHECK(parses("\n   # nothing but a comment\nresource r \"r\" r.png a:2\n"));
+
+    return test_result("content");
+}
@@ -0,0 +1,114 @@
+//DropSampler against independent per object rolls on tables of several objects: which objects drop together on
+//a tick is one outcome out of 2^n, and its counts over many ticks must fit the product of the per object chances
+//the countdown, the first_drop pick and the next_drop chain are checked separately and as a whole
+
+#include "test.h"
+#include "drop_sampler.h"
+
+constexpr size_t TICKS = 2000000;
+constexpr size_t DROP_TICKS = 1000000;
+
+//chance of each combination of drops, bit i set when object i drops
+std::vector<double> outcome_chances(const std::vector<int>& rates)
+{
+    std::vector<double> chances(size_t{1} << rates.size(), 1.0);
+    for(size_t mask=0; mask<chances.size(); mask++)
+        for(size_t i=0; i<rates.size(); i++)
+            chances[mask] *= (mask >> i & 1) ? 1.0 / rates[i] : 1.0 - 1.0 / rates[i];
+    return chances;
+}
+
+std::vector<double> scaled(const std::vector<double>& chances, double total)
+{
+    std::vector<double> expected(chances.size());
+    for(size_t i=0; i<chances.size(); i++)
+        expected[i] = chances[i] * total;
+    return expected;
+}
+
+size_t drop_tick_outcome(const DropSampler& sampler, Rng& rng)
+{
+    size_t mask = 0;
+    sampler.sampleDropTick(rng, [&mask](size_t i)
+    {
+        mask |= size_t{1} << i;
+        return true;
+    });
+    return mask;
+}
+
+void check_table(const std::vector<int>& rates, std::uint64_t seed)
+{
+    DropSampler sampler(rates);
+    std::vector<double> chances = outcome_chances(rates);
+    const double miss = chances[0];
+
+    //the reference itself: per object rolls fit the product, so a failure below is the sampler's
+    Rng rng(seed);
+    std::vector<double> rolled(chances.size(), 0.0);
+    for(size_t t=0; t<TICKS; t++)
+    {
+        size_t mask = 0;
+        for(size_t i=0; i<rates.size(); i++)
+            if(rng.bounded(static_cast<std::uint32_t>(rates[i])) == 0)
+                mask |= size_t{1} << i;
+        rolled[mask]++;
+    }
+    CHECK(chi_square_fits(rolled, scaled(chances, TICKS)));
+
+    //on a tick where something drops, the combination is the product given that not all objects missed
+    std::vector<double> picked(chances.size(), 0.0);
+    for(size_t t=0; t<DROP_TICKS; t++)
+        picked[drop_tick_outcome(sampler, rng)]++;
+    CHECK(picked[0] == 0.0);
+    std::vector<double> given_drop = chances;
+    given_drop[0] = 0.0;
+    CHECK(chi_square_fits(picked, scaled(given_drop, DROP_TICKS / (1.0 - miss))));
+
+    //whole ticks the way the simulation runs them: a countdown of empty ticks, then a drop tick
+    std::vector<double> ticked(chances.size(), 0.0);
+    std::vector<double> waits(64, 0.0);
+    size_t t = 0;
+    while(t < TICKS)
+    {
+        std::uint64_t wait = sampler.ticksToNextDrop(rng, TICKS - t);
+        waits[std::min<std::uint64_t>(wait, waits.size()) - 1]++;
+        ticked[0] += static_cast<double>(wait - 1);
+        t += wait;
+        if(t <= TICKS)
+            ticked[drop_tick_outcome(sampler, rng)]++;
+    }
+    CHECK(chi_square_fits(ticked, scaled(chances, static_cast<double>(TICKS))));
+
+    //the wait is geometric in the chance that anything drops, the last cell holds the tail
+    double draws = 0.0;
+    for(double count : waits)
+        draws += count;
+    std::vector<double> geometric(waits.size());
+    for(size_t k=0; k<waits.size(); k++)
+        geometric[k] = draws * (k + 1 < waits.size() ? std::pow(miss, static_cast<double>(k)) * (1.0 - miss) : std::pow(miss, static_cast<double>(k)));
+    CHECK(chi_square_fits(waits, geometric));
+}
+
+int main()
+{
+    check_table({2, 3, 5, 8, 13, 40}, 1);
+    check_table({20, 7, 100, 3}, 2);
+    //an object that always drops makes every tick a drop tick
+    check_table({1, 4, 6}, 3);
+
+    //a callback returning false ends the tick
+    DropSampler sampler(std::vector<int>{1, 1, 1});
+    Rng rng;
+    size_t calls = 0;
+    sampler.sampleDropTick(rng, [&calls](size_t)
+    {
+        calls++;
+        return false;
+    });
+    CHECK(calls == 1);
+    CHECK(sampler.ticksToNextDrop(rng, 100) == 1);
+    CHECK(DropSampler().ticksToNextDrop(rng, 100) == 100);
+
+    return test_result("drop sampler");
+}
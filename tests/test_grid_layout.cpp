@@ -0,0 +1,68 @@
+//GridLayout::cellAt against the fmod hit test it replaced, over every quarter pixel of the inventory's rect and of
+//a grid filling the game screen's, and every box's own corners map to its cell
+
+#include "test.h"
+#include "grid_layout.h"
+
+//the hit test as GameScreen::handleMouseClick had it, -1 for no cell
+int old_cell_at(float x, float y, float rect_x, float rect_y, float rect_w, float rect_h, int cells_x, int cells_y)
+{
+    float stepX = GRID_LINE_WIDTH + GRID_BOX_WIDTH;
+    float stepY = GRID_LINE_WIDTH + GRID_BOX_HEIGHT;
+    float total_grid_width = cells_x * stepX + GRID_LINE_WIDTH;
+    float total_grid_height = cells_y * stepY + GRID_LINE_WIDTH;
+    float x1 = rect_x + (rect_w - total_grid_width)/2.0f;
+    float y1 = rect_y + (rect_h - total_grid_height)/2.0f;
+    float posx = x - x1;
+    float posy = y - y1;
+    if(posx < 0 || posy < 0)
+        return -1;
+    float localX = std::fmod(posx, stepX);
+    float localY = std::fmod(posy, stepY);
+    if(localX < GRID_LINE_WIDTH || localY < GRID_LINE_WIDTH)
+        return -1;
+    int column = static_cast<int>(posx / stepX);
+    int row = static_cast<int>(posy / stepY);
+    if(column >= cells_x || row >= cells_y)
+        return -1;
+    return row * cells_x + column;
+}
+
+void check_layout(float rect_x, float rect_y, float rect_w, float rect_h, size_t cells_x, size_t cells_y)
+{
+    GridLayout layout(rect_x, rect_y, rect_w, rect_h, cells_x, cells_y, cells_x * cells_y);
+    size_t points = 0;
+    size_t mismatches = 0;
+    for(float y = rect_y - 4.0f; y < rect_y + rect_h + 4.0f; y += 0.25f)
+        for(float x = rect_x - 4.0f; x < rect_x + rect_w + 4.0f; x += 0.25f)
+        {
+            int old = old_cell_at(x, y, rect_x, rect_y, rect_w, rect_h, static_cast<int>(cells_x), static_cast<int>(cells_y));
+            std::optional<size_t> cell = layout.cellAt(x, y);
+            if(old < 0 ? cell.has_value() : cell != static_cast<size_t>(old))
+                mismatches++;
+            points++;
+        }
+    CHECK(points > 0 && mismatches == 0);
+
+    for(size_t cell=0; cell<layout.cellCount(); cell++)
+    {
+        SDL_FRect box = layout.box(cell);
+        CHECK(layout.cellAt(box.x, box.y) == cell);
+        CHECK(layout.cellAt(box.x + box.w - 0.25f, box.y + box.h - 0.25f) == cell);
+        CHECK(!layout.cellAt(box.x - 0.25f, box.y));
+    }
+}
+
+int main()
+{
+    check_layout(UIS_X, UIS_Y, UIS_W, UIS_H, UI_cellsX, UI_cellsY);
+    check_layout(GS_X, GS_Y, GS_W, GS_H, static_cast<size_t>((GS_W - GRID_LINE_WIDTH) / (GRID_LINE_WIDTH + GRID_BOX_WIDTH)),
+        static_cast<size_t>((GS_H - GRID_LINE_WIDTH) / (GRID_LINE_WIDTH + GRID_BOX_HEIGHT)));
+
+    //cells past the used ones are not hit
+    GridLayout partial(0.0f, 0.0f, 200.0f, 200.0f, 4, 4, 5);
+    CHECK(partial.cellAt(partial.box(4).x + 1.0f, partial.box(4).y + 1.0f) == 4u);
+    CHECK(!partial.cellAt(partial.box(5).x + 1.0f, partial.box(5).y + 1.0f));
+
+    return test_result("grid layout");
+}
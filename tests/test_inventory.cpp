@@ -0,0 +1,128 @@
+//Inventory against a plain vector of slots: random adds, placements and removals, after each one every slot,
+//count and the occupancy must match what the vector says
+//removing by object takes the copy placed last, the vector keeps a placement number per slot to find it
+
+#include "test.h"
+#include "inventory.h"
+#include "random.h"
+
+struct ReferenceInventory
+{
+    std::vector<std::optional<ObjectId>> slots;
+    std::vector<size_t> placed_at;
+    size_t placements = 0;
+
+    explicit ReferenceInventory(size_t capacity) : slots(capacity), placed_at(capacity, 0) {}
+
+    void place(size_t slot, ObjectId item)
+    {
+        slots[slot] = item;
+        placed_at[slot] = placements++;
+    }
+
+    std::optional<size_t> add(ObjectId item)
+    {
+        for(size_t i=0; i<slots.size(); i++)
+            if(!slots[i])
+            {
+                place(i, item);
+                return i;
+            }
+        return std::nullopt;
+    }
+
+    bool remove(ObjectId item)
+    {
+        std::optional<size_t> last;
+        for(size_t i=0; i<slots.size(); i++)
+            if(slots[i] == item && (!last || placed_at[i] > placed_at[*last]))
+                last = i;
+        if(last)
+            slots[*last].reset();
+        return last.has_value();
+    }
+
+    size_t count(ObjectId item) const
+    {
+        return static_cast<size_t>(std::count(slots.begin(), slots.end(), std::optional<ObjectId>(item)));
+    }
+
+    size_t occupancy() const
+    {
+        return static_cast<size_t>(std::count_if(slots.begin(), slots.end(), [](const std::optional<ObjectId>& slot){ return slot.has_value(); }));
+    }
+};
+
+constexpr size_t OBJECTS = 12;
+
+bool matches(const Inventory& inventory, const ReferenceInventory& reference)
+{
+    if(inventory.getOccupancy() != reference.occupancy() || inventory.isFull() != (reference.occupancy() == reference.slots.size()))
+        return false;
+    for(size_t i=0; i<reference.slots.size(); i++)
+        if(inventory.at(i) != reference.slots[i])
+            return false;
+    for(size_t id=0; id<OBJECTS; id++)
+    {
+        ObjectId item = static_cast<ObjectId>(id);
+        if(inventory.count(item) != reference.count(item) || inventory.contains(item) != (reference.count(item) > 0))
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    //sizes around the bitmap's word and level boundaries
+    for(size_t capacity : {1, 50, 63, 64, 65, 4096, 4097})
+    {
+        Inventory inventory(capacity);
+        ReferenceInventory reference(capacity);
+        Rng rng(capacity);
+        size_t mismatches = 0;
+        for(size_t step=0; step<20000; step++)
+        {
+            ObjectId item = static_cast<ObjectId>(rng.bounded(OBJECTS));
+            size_t slot = rng.bounded(static_cast<std::uint32_t>(capacity));
+            //more adds than removals early on, the other way round later, so the inventory fills and empties
+            bool filling = (step / 5000) % 2 == 0;
+            switch(rng.bounded(4))
+            {
+                case 0:
+                case 1:
+                    if(filling)
+                        CHECK(inventory.add(item) == reference.add(item));
+                    else
+                        CHECK(inventory.remove(item) == reference.remove(item));
+                    break;
+                case 2:
+                {
+                    bool placed = inventory.place(slot, item);
+                    CHECK(placed == !reference.slots[slot]);
+                    if(placed)
+                        reference.place(slot, item);
+                    break;
+                }
+                default:
+                {
+                    bool removed = inventory.removeAt(slot);
+                    CHECK(removed == reference.slots[slot].has_value());
+                    reference.slots[slot].reset();
+                    break;
+                }
+            }
+            if(!matches(inventory, reference))
+                mismatches++;
+        }
+        CHECK(mismatches == 0);
+        inventory.clear();
+        CHECK(matches(inventory, ReferenceInventory(capacity)));
+    }
+
+    //out of range slots are refused
+    Inventory small(4);
+    CHECK(!small.place(4, ObjectId{}));
+    CHECK(!small.removeAt(4));
+
+    return test_result("inventory");
+}
@@ -0,0 +1,83 @@
+//resolve_offline_ticks against the per-tick loop it replaces: over many seeds the ticks consumed, the items of
+//each object gained and how often the inventory fills must have the same distribution
+
+#include "test.h"
+#include "simulation.h"
+
+constexpr size_t RUNS = 20000;
+constexpr size_t INVENTORY = 20;
+//about the ticks the inventory takes to fill, so some runs fill it and some do not
+constexpr std::uint64_t TICKS = 40;
+
+struct Outcome
+{
+    Moments ticks;
+    std::array<Moments, 3> yield;
+    Moments full;
+};
+
+int main()
+{
+    std::shared_ptr<const Content> content = test_content(R"(
+object a "a" a.png
+object b "b" b.png
+object c "c" c.png
+resource ore "ore" ore.png a:3 b:7 c:20
+)");
+    const ResourceId ore = *content->findResource("ore");
+
+    Outcome per_tick;
+    Outcome resolved;
+    for(size_t run=0; run<RUNS; run++)
+    {
+        Simulation simulation(INVENTORY);
+        simulation.setContent(content);
+        simulation.seed(run);
+        simulation.startMining(ore);
+        std::uint64_t ticks = TICKS;
+        for(std::uint64_t t=1; t<=TICKS; t++)
+        {
+            simulation.tick();
+            if(simulation.getPlayer().getAction() == IDLE)
+            {
+                ticks = t;
+                break;
+            }
+        }
+        per_tick.ticks.add(static_cast<double>(ticks));
+        per_tick.full.add(simulation.getPlayer().getAction() == IDLE ? 1.0 : 0.0);
+        for(size_t i=0; i<3; i++)
+            per_tick.yield[i].add(static_cast<double>(simulation.getPlayer().getInventory().count(static_cast<ObjectId>(i))));
+
+        Player player(INVENTORY);
+        Rng rng(run + RUNS);
+        OfflineProgress progress = resolve_offline_ticks(content->drops(ore), content->sampler(ore), player, TICKS, rng);
+        resolved.ticks.add(static_cast<double>(progress.ticks));
+        resolved.full.add(progress.inventory_full ? 1.0 : 0.0);
+        for(size_t i=0; i<3; i++)
+            resolved.yield[i].add(static_cast<double>(player.getInventory().count(static_cast<ObjectId>(i))));
+        CHECK(progress.drops.size() == player.getInventory().getOccupancy());
+    }
+
+    CHECK(per_tick.full.mean() > 0.1 && per_tick.full.mean() < 0.9);
+    CHECK(same_mean(per_tick.ticks, resolved.ticks));
+    CHECK(same_mean(per_tick.full, resolved.full));
+    for(size_t i=0; i<3; i++)
+    {
+        CHECK(same_mean(per_tick.yield[i], resolved.yield[i]));
+        //variances agree within a few percent at this many runs
+        CHECK(std::abs(per_tick.yield[i].variance() / resolved.yield[i].variance() - 1.0) < 0.1);
+    }
+    CHECK(std::abs(per_tick.ticks.variance() / resolved.ticks.variance() - 1.0) < 0.1);
+
+    //a full inventory stops on the first tick, nothing requested does nothing
+    Player full(1);
+    full.addItem(ObjectId{});
+    Rng rng;
+    OfflineProgress stopped = resolve_offline_ticks(content->drops(ore), content->sampler(ore), full, 1000, rng);
+    CHECK(stopped.ticks == 1 && stopped.inventory_full && stopped.drops.empty());
+    Player empty(INVENTORY);
+    CHECK(resolve_offline_ticks(content->drops(ore), content->sampler(ore), empty, 0, rng).ticks == 0);
+
+    return test_result("offline_progress");
+}
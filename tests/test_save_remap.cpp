@@ -0,0 +1,114 @@
+//saves and journals written with one content table read with another that reorders, adds and removes entries:
+//every item comes back under its key in its slot, items and targets whose key is gone are dropped, and a
+//journal replayed through the snapshot's keys gives the same inventory as swapping the content in memory
+
+#include "test.h"
+#include "simulation.h"
+#include "journal.h"
+
+constexpr size_t INVENTORY = 40;
+
+//the key of every slot, empty where the slot is or where content has no such entry
+std::vector<std::string> slot_keys(const Simulation& simulation)
+{
+    const Inventory& inventory = simulation.getPlayer().getInventory();
+    std::vector<std::string> keys(inventory.size());
+    for(size_t i=0; i<keys.size(); i++)
+        if(std::optional<ObjectId> item = inventory.at(i))
+            keys[i] = simulation.getContent().key(*item);
+    return keys;
+}
+
+//the keys with those content no longer has emptied
+std::vector<std::string> without(std::vector<std::string> keys, const Content& content)
+{
+    for(std::string& key : keys)
+        if(!key.empty() && !content.findObject(key))
+            key.clear();
+    return keys;
+}
+
+void run(Simulation& simulation, const char *resource, size_t ticks)
+{
+    simulation.startMining(*simulation.getContent().findResource(resource));
+    for(size_t i=0; i<ticks; i++)
+        simulation.tick();
+    simulation.clearEvents();
+}
+
+int main()
+{
+    ScratchDirectory scratch("save_remap");
+    std::filesystem::create_directories(SAVE_DIRECTORY);
+    std::shared_ptr<const Content> before = test_content(R"(
+object copper "copper" copper.png
+object tin "tin" tin.png
+object ruby "ruby" ruby.png
+object opal "opal" opal.png
+resource copper_rock "copper rock" copper_rock.png copper:1
+resource tin_rock "tin rock" tin_rock.png tin:1
+resource gem_rock "gem rock" gem_rock.png ruby:2 opal:3 tin:4
+)");
+    //ruby and tin_rock are gone, entries are reordered and one is new
+    std::shared_ptr<const Content> after = test_content(R"(
+object opal "opal" opal.png
+object iron "iron" iron.png
+object tin "tin" tin.png
+object copper "copper" copper.png
+resource gem_rock "gem rock" gem_rock.png opal:3 tin:4
+resource iron_rock "iron rock" iron_rock.png iron:5
+resource copper_rock "copper rock" copper_rock.png copper:1
+)");
+
+    Simulation played(INVENTORY);
+    played.setContent(before);
+    played.seed(7);
+    run(played, "copper_rock", 3);
+    run(played, "tin_rock", 2);
+    run(played, "gem_rock", 10);
+    SaveWriter writer;
+    played.writeSave(writer);
+    CHECK(writer.writeAtomically(SAVE_DIRECTORY + "remap.sqs"));
+    const std::vector<std::string> saved = slot_keys(played);
+
+    //what happens after the snapshot goes to a journal in the snapshot's ids
+    Journal journal;
+    CHECK(journal.open(1));
+    played.attachJournal(&journal);
+    run(played, "gem_rock", 10);
+    run(played, "copper_rock", 2);
+    journal.commit();
+    journal.close();
+    played.attachJournal(nullptr);
+    const std::vector<std::string> journaled = slot_keys(played);
+
+    SaveReader reader;
+    CHECK(reader.open(SAVE_DIRECTORY + "remap.sqs"));
+    Simulation loaded(INVENTORY);
+    loaded.setContent(after);
+    IdMap ids = after->readKeys(reader);
+    CHECK(loaded.readSave(reader, ids));
+    CHECK(slot_keys(loaded) == without(saved, *after));
+    CHECK(loaded.getPlayerTarget() == after->findResource("gem_rock"));
+    CHECK(loaded.getPlayer().getAction() == MINING);
+    //the save held ruby and tin, the first is dropped and the second kept
+    CHECK(std::count(saved.begin(), saved.end(), "ruby") > 0 && std::count(saved.begin(), saved.end(), "tin") > 0);
+
+    JournalReader journal_reader;
+    CHECK(journal_reader.open(journal_path(1)) && journal_reader.getCheckpointId() == 1);
+    CHECK(loaded.replayJournal(journal_reader, ids) > 0);
+    CHECK(slot_keys(loaded) == without(journaled, *after));
+    CHECK(loaded.getPlayerTarget() == after->findResource("copper_rock"));
+
+    //swapping the content in memory agrees with the round trip
+    played.setContent(after);
+    CHECK(slot_keys(played) == slot_keys(loaded));
+
+    //a target whose key is gone stops mining
+    Simulation stranded(INVENTORY);
+    stranded.setContent(before);
+    run(stranded, "tin_rock", 1);
+    stranded.setContent(after);
+    CHECK(!stranded.getPlayerTarget() && stranded.getPlayer().getAction() == IDLE);
+    return test_result("save remap");
+}
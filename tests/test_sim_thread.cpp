@@ -0,0 +1,73 @@
+//a loaded game is credited the time since it was saved exactly once: a game that gains one item every tick is
+//saved paused, the menu is left idle for a few ticks, and the load must add the ticks from saved_at to now and
+//not again the time the simulation thread slept through in the menu
+
+#include "test.h"
+#include "sim_thread.h"
+
+//a few ticks, and more than the ticks played live in one pass, so crediting the menu time twice shows
+constexpr std::chrono::milliseconds MENU_TIME(5 * TICK);
+constexpr std::chrono::seconds COMMAND_TIMEOUT(10);
+
+std::uint64_t wall_ms()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+//false if the command was not applied in time
+bool wait_for(SimThread& sim, std::uint64_t command)
+{
+    auto deadline = std::chrono::steady_clock::now() + COMMAND_TIMEOUT;
+    while(std::chrono::steady_clock::now() < deadline)
+    {
+        sim.acquire();
+        if(command != 0 && sim.snapshot().handled_commands >= command)
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+size_t items(const SimThread& sim)
+{
+    const std::vector<std::optional<ObjectId>>& slots = sim.snapshot().inventory.slots;
+    return static_cast<size_t>(std::count_if(slots.begin(), slots.end(), [](const std::optional<ObjectId>& slot){ return slot.has_value(); }));
+}
+
+int main()
+{
+    //saves go to the scratch directory's SAVE_DIRECTORY, never the game's
+    ScratchDirectory scratch("sim_thread");
+    SimThread sim;
+    sim.start();
+    //one object dropping every tick, the item count is the ticks played or credited
+    sim.setContent(test_content(R"(
+object a "a" a.png
+resource r "r" r.png a:1
+)"));
+    sim.send({SimCommandType::NEW_GAME, 0});
+    sim.send({SimCommandType::PAUSE, 0});
+    sim.send({SimCommandType::START_MINING, 0});
+    std::uint64_t save_sent = wall_ms();
+    sim.send({SimCommandType::SAVE_GAME, 0});
+    CHECK(wait_for(sim, sim.send({SimCommandType::END_GAME, 0})));
+    std::uint64_t save_seen = wall_ms();
+    CHECK(items(sim) == 0);
+
+    std::this_thread::sleep_for(MENU_TIME);
+    CHECK(std::filesystem::exists(SAVE_DIRECTORY + "slot1.sqs"));
+
+    std::uint64_t load_sent = wall_ms();
+    //the snapshot of the pass that loaded, the next tick is not due before a whole TICK later
+    CHECK(wait_for(sim, sim.send({SimCommandType::LOAD_GAME, 0})));
+    std::uint64_t load_seen = wall_ms();
+    CHECK(sim.snapshot().in_game && sim.snapshot().action == MINING);
+    size_t lowest = static_cast<size_t>((load_sent - save_seen) / TICK);
+    size_t highest = static_cast<size_t>((load_seen - save_sent) / TICK);
+    size_t credited = items(sim);
+    std::cout<<"credited "<<credited<<" ticks, expected "<<lowest<<" to "<<highest<<"\n";
+    CHECK(credited >= lowest && credited <= highest);
+    CHECK(lowest > 0);
+    return test_result("sim thread");
+}
@@ -0,0 +1,125 @@
+//the world is a function of the seed and the coordinates alone: chunks visited in any order hold the same tiles,
+//only the chunks looked at are generated, every resource sits on its spawn tile, nodes cover about
+//WORLD_NODES_PER_MILLE of the other tiles, and a content change moves every node to its key's new id
+
+#include "test.h"
+#include "world_map.h"
+
+constexpr size_t CHUNKS = 8;
+
+std::vector<std::uint16_t> all_tiles(WorldMap& world)
+{
+    std::vector<std::uint16_t> tiles;
+    for(size_t y=0; y<world.tilesY(); y++)
+        for(size_t x=0; x<world.tilesX(); x++)
+        {
+            std::optional<ResourceId> resource = world.resourceAt(x, y);
+            tiles.push_back(resource ? static_cast<std::uint16_t>(*resource) : NO_CONTENT_ID);
+        }
+    return tiles;
+}
+
+bool in_spawn_block(const WorldMap& world, size_t x, size_t y, size_t resources)
+{
+    for(size_t i=0; i<resources; i++)
+        if(world.spawnTile(static_cast<ResourceId>(i)) == TileCoord{x, y})
+            return true;
+    return false;
+}
+
+int main()
+{
+    //row by row, and chunk by chunk in a shuffled order after a few scattered lookups
+    WorldMap in_order(CHUNKS, CHUNKS);
+    in_order.reset(42, 5);
+    WorldMap shuffled(CHUNKS, CHUNKS);
+    shuffled.reset(42, 5);
+    CHECK(shuffled.generatedChunks() == 0);
+    shuffled.resourceAt(shuffled.tilesX() - 1, 3);
+    CHECK(shuffled.generatedChunks() == 1);
+    std::vector<size_t> order(CHUNKS * CHUNKS);
+    for(size_t i=0; i<order.size(); i++)
+        order[i] = i;
+    Rng rng(9);
+    for(size_t i=order.size(); i-- > 1;)
+        std::swap(order[i], order[rng.bounded(static_cast<std::uint32_t>(i + 1))]);
+    for(size_t i : order)
+        shuffled.chunk(i % CHUNKS, i / CHUNKS);
+    CHECK(shuffled.generatedChunks() == CHUNKS * CHUNKS);
+    const std::vector<std::uint16_t> tiles = all_tiles(in_order);
+    CHECK(tiles == all_tiles(shuffled));
+    //reset forgets every chunk and gives the same world again, another seed another world
+    shuffled.reset(42, 5);
+    CHECK(shuffled.generatedChunks() == 0);
+    CHECK(tiles == all_tiles(shuffled));
+    shuffled.reset(43, 5);
+    CHECK(tiles != all_tiles(shuffled));
+
+    //spawn tiles, then the node share of the rest of a full size world
+    WorldMap world;
+    world.reset(DEFAULT_RNG_SEED, 20);
+    for(size_t i=0; i<20; i++)
+    {
+        std::optional<TileCoord> tile = world.spawnTile(static_cast<ResourceId>(i));
+        CHECK(tile && world.resourceAt(tile->x, tile->y) == static_cast<ResourceId>(i));
+    }
+    CHECK(!world.spawnTile(static_cast<ResourceId>(20)));
+    CHECK(!world.resourceAt(world.tilesX(), 0) && !world.resourceAt(0, world.tilesY()));
+    Moments nodes;
+    for(size_t y=0; y<world.tilesY(); y++)
+        for(size_t x=0; x<world.tilesX(); x++)
+            if(!in_spawn_block(world, x, y, 20))
+                nodes.add(world.resourceAt(x, y) ? 1.0 : 0.0);
+    double share = static_cast<double>(WORLD_NODES_PER_MILLE) / 1000.0;
+    CHECK(std::abs(nodes.mean() - share) < 5.0 * std::sqrt(share * (1.0 - share) / nodes.n));
+
+    //content that reorders the resources, drops two and adds one: nodes keep their key, the dropped one's become
+    //bare ground and the spawn block is laid out again in the new order
+    std::shared_ptr<const Content> before = test_content(R"(
+object a "a" a.png
+resource copper "copper" copper.png a:2
+resource tin "tin" tin.png a:2
+resource iron "iron" iron.png a:2
+)");
+    std::shared_ptr<const Content> after = test_content(R"(
+object a "a" a.png
+resource gold "gold" gold.png a:2
+resource copper "copper" copper.png a:2
+)");
+    IdMap ids = after->mapFrom(*before);
+    WorldMap remapped(CHUNKS, CHUNKS);
+    remapped.reset(7, before->resourceCount());
+    const std::vector<std::uint16_t> old_tiles = all_tiles(remapped);
+    std::uint64_t revision = remapped.chunk(0, 0).revision;
+    remapped.remap(ids, after->resourceCount());
+    CHECK(remapped.chunk(0, 0).revision != revision);
+    size_t mismatches = 0;
+    for(size_t y=0; y<remapped.tilesY(); y++)
+        for(size_t x=0; x<remapped.tilesX(); x++)
+        {
+            if(in_spawn_block(remapped, x, y, std::max(before->resourceCount(), after->resourceCount())))
+                continue;
+            std::uint16_t old = old_tiles[y * remapped.tilesX() + x];
+            std::optional<ResourceId> expected = old == NO_CONTENT_ID ? std::nullopt : ids.resource(old);
+            if(remapped.resourceAt(x, y) != expected)
+                mismatches++;
+        }
+    CHECK(mismatches == 0);
+    for(size_t i=0; i<after->resourceCount(); i++)
+    {
+        TileCoord tile = *remapped.spawnTile(static_cast<ResourceId>(i));
+        CHECK(remapped.resourceAt(tile.x, tile.y) == static_cast<ResourceId>(i));
+    }
+    //a chunk first looked at after the change only holds the new resources
+    WorldMap partly(CHUNKS, CHUNKS);
+    partly.reset(7, before->resourceCount());
+    partly.chunk(0, 0);
+    partly.remap(ids, after->resourceCount());
+    size_t out_of_range = 0;
+    for(std::uint16_t tile : partly.chunk(CHUNKS - 1, CHUNKS - 1).tiles)
+        if(tile != NO_CONTENT_ID && tile >= after->resourceCount())
+            out_of_range++;
+    CHECK(out_of_range == 0);
+
+    return test_result("world map");
+}
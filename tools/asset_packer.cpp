@@ -0,0 +1,102 @@
+//packs the game's assets into one bundle (see src/asset_bundle.h) so startup maps a single file instead of
+//opening and decoding every sprite: PNGs are stored decoded to RGBA32, any other asset as its file's bytes
+//entries keep the path the game loads them from, the asset directory's path relative to the game is "assets/"
+//
+//usage: asset_packer ASSET_DIR OUTPUT
+
+#include "../src/constants.h"
+#include "../src/asset_bundle.h"
+#include <fstream>
+
+//game side prefix of every path in the bundle
+const std::string ASSET_PREFIX = "assets/";
+
+std::optional<std::vector<std::uint8_t>> read_file(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+        return std::nullopt;
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if(file.bad())
+        return std::nullopt;
+    return bytes;
+}
+
+bool pack_image(BundleWriter& writer, const std::filesystem::path& path, std::string bundle_path)
+{
+    SDL_Surface *loaded = IMG_Load(path.string().c_str());
+    if(!loaded)
+    {
+        std::cerr<<"Failed to load "<<path.string()<<": "<<SDL_GetError()<<"\n";
+        return false;
+    }
+    SDL_Surface *rgba = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(loaded);
+    if(!rgba)
+    {
+        std::cerr<<"Failed to convert "<<path.string()<<": "<<SDL_GetError()<<"\n";
+        return false;
+    }
+    size_t row_size = static_cast<size_t>(rgba->w) * 4;
+    std::vector<std::uint8_t> pixels(row_size * static_cast<size_t>(rgba->h));
+    for(int y=0; y<rgba->h; y++)
+        std::memcpy(pixels.data() + row_size * static_cast<size_t>(y), static_cast<const std::uint8_t*>(rgba->pixels) + static_cast<size_t>(rgba->pitch) * static_cast<size_t>(y), row_size);
+    writer.addImage(std::move(bundle_path), static_cast<std::uint32_t>(rgba->w), static_cast<std::uint32_t>(rgba->h), std::move(pixels));
+    SDL_DestroySurface(rgba);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc != 3)
+    {
+        std::cerr<<"usage: asset_packer ASSET_DIR OUTPUT\n";
+        return 1;
+    }
+    std::filesystem::path asset_dir = argv[1];
+    std::filesystem::path output = argv[2];
+
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for(const auto& entry : std::filesystem::recursive_directory_iterator(asset_dir, ec))
+        if(entry.is_regular_file() && entry.path().extension() != ".pack")
+            files.push_back(entry.path());
+    if(ec)
+    {
+        std::cerr<<"Failed to list "<<asset_dir.string()<<": "<<ec.message()<<"\n";
+        return 1;
+    }
+    //the same assets always give the same bundle
+    std::sort(files.begin(), files.end());
+
+    BundleWriter writer;
+    bool ok = true;
+    for(const std::filesystem::path& path : files)
+    {
+        std::string bundle_path = ASSET_PREFIX + path.lexically_relative(asset_dir).generic_string();
+        if(path.extension() == ".png")
+        {
+            ok = pack_image(writer, path, std::move(bundle_path)) && ok;
+            continue;
+        }
+        std::optional<std::vector<std::uint8_t>> bytes = read_file(path);
+        if(!bytes)
+        {
+            std::cerr<<"Failed to read "<<path.string()<<"\n";
+            ok = false;
+            continue;
+        }
+        writer.addFile(std::move(bundle_path), std::move(*bytes));
+    }
+    if(!ok)
+        return 2;
+
+    std::vector<std::uint8_t> bytes = writer.finish();
+    if(!write_file_atomically(output, bytes))
+    {
+        std::cerr<<"Failed to write "<<output.string()<<"\n";
+        return 3;
+    }
+    std::cout<<"packed "<<writer.size()<<" assets into "<<output.string()<<" ("<<bytes.size()<<" bytes)\n";
+    return 0;
+}
@@ -0,0 +1,686 @@
+//micro and macro benchmarks, results go to JSON so runs of different versions can be compared
+//the core benchmarks only need the headless simulation headers; text, full frame and sprite loading benchmarks render
+//through SDL's software renderer into an offscreen surface and are built when SKILLQUEST_BENCH_RENDER is defined
+//
+//usage: benchmarks [--json PATH] [--filter TEXT] [--min-time SECONDS] [--baseline PATH] [--threshold FRACTION] [--list]
+//with --baseline every benchmark is compared with the same name in an earlier JSON file, and the exit code is 3
+//if any got slower by more than the threshold (default 10%)
+
+#ifdef SKILLQUEST_BENCH_RENDER
+#include "../src/asset_loader.h"
+#include "../src/frame_scheduler.h"
+#include "../src/game_screen.h"
+#include "../src/icon_screen.h"
+#include "../src/text_screen.h"
+#include "../src/ui_screen.h"
+#endif
+#include "../src/simulation.h"
+#include "../src/world_map.h"
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+
+#ifndef SKILLQUEST_BUILD_TYPE
+#define SKILLQUEST_BUILD_TYPE "unknown"
+#endif
+#ifdef __VERSION__
+#define BENCH_COMPILER __VERSION__
+#else
+#define BENCH_COMPILER "unknown"
+#endif
+
+//each benchmark is timed over this many batches, the median batch is reported
+constexpr int BENCH_SAMPLES = 7;
+constexpr std::uint64_t BENCH_MAX_ITERATIONS = std::uint64_t{1} << 32;
+
+//keeps the compiler from dropping a result it can see is unused
+template<typename T>
+void keep(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &value;
+#endif
+}
+
+struct Benchmark
+{
+    std::string name;
+    //runs the measured operation the given number of times
+    std::function<void(std::uint64_t)> run;
+};
+
+struct BenchResult
+{
+    std::string name;
+    std::uint64_t iterations;
+    double ns_per_op;
+    double min_ns;
+    double max_ns;
+};
+
+struct Options
+{
+    std::string json_path = "benchmarks.json";
+    std::string filter;
+    double min_time = 0.5;
+    std::string baseline;
+    double threshold = 0.10;
+    bool list = false;
+};
+
+double time_batch(const Benchmark& bench, std::uint64_t iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    bench.run(iterations);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+//grows the batch until it takes min_time / BENCH_SAMPLES, then times BENCH_SAMPLES batches of that size
+BenchResult measure(const Benchmark& bench, double min_time)
+{
+    double batch_ns = min_time * 1e9 / BENCH_SAMPLES;
+    std::uint64_t iterations = 1;
+    double elapsed = time_batch(bench, iterations);
+    while(elapsed < batch_ns && iterations < BENCH_MAX_ITERATIONS)
+    {
+        double scale = elapsed > 0.0 ? std::min(batch_ns * 1.2 / elapsed, 10.0) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<std::uint64_t>(static_cast<double>(iterations) * scale));
+        elapsed = time_batch(bench, iterations);
+    }
+
+    std::array<double, BENCH_SAMPLES> samples;
+    for(double& sample : samples)
+        sample = time_batch(bench, iterations) / static_cast<double>(iterations);
+    std::sort(samples.begin(), samples.end());
+    return {bench.name, iterations, samples[BENCH_SAMPLES / 2], samples.front(), samples.back()};
+}
+
+void print_result(const BenchResult& result)
+{
+    std::printf("%-52s %12.1f ns/op  (min %.1f, max %.1f, %llu per batch)\n", result.name.c_str(), result.ns_per_op,
+        result.min_ns, result.max_ns, static_cast<unsigned long long>(result.iterations));
+}
+
+//player with the given share of its slots taken, cycling through object_count objects but never holding
+//probe so lookups of it miss
+Player filled_player(size_t slots, double fill, size_t object_count, ObjectId probe)
+{
+    Player player(slots);
+    size_t count = static_cast<size_t>(static_cast<double>(slots) * fill);
+    size_t object = 0;
+    for(size_t i=0; i<count; i++)
+    {
+        if(static_cast<ObjectId>(object) == probe)
+            object = (object + 1) % object_count;
+        player.addItem(static_cast<ObjectId>(object));
+        object = (object + 1) % object_count;
+    }
+    return player;
+}
+
+//a content table of the given size in the file format, every resource dropping drops objects
+std::string synthetic_content(size_t objects, size_t resources, size_t drops)
+{
+    std::string text;
+    for(size_t i=0; i<objects; i++)
+        text += "object object_" + std::to_string(i) + " \"object " + std::to_string(i) + "\" object_" + std::to_string(i) + ".png\n";
+    for(size_t r=0; r<resources; r++)
+    {
+        text += "resource resource_" + std::to_string(r) + " \"resource " + std::to_string(r) + "\" resource_" + std::to_string(r) + ".png";
+        for(size_t i=0; i<drops; i++)
+            text += " object_" + std::to_string((r * drops + i) % objects) + ":" + std::to_string(5 + i * 40);
+        text += "\n";
+    }
+    return text;
+}
+
+void add_core_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+    const Content& content = *Content::defaults();
+
+    //one tick of mining each resource, the inventory is emptied whenever it fills up as the player would
+    for(size_t r=0; r<content.resourceCount(); r++)
+    {
+        auto sim = std::make_shared<Simulation>();
+        ResourceId name = static_cast<ResourceId>(r);
+        benchmarks.push_back({"sim/extractResource/" + std::string(content.key(name)), [sim, name](std::uint64_t n)
+        {
+            if(sim->getPlayer().getAction() != MINING)
+                sim->startMining(name);
+            for(std::uint64_t i=0; i<n; i++)
+            {
+                keep(sim->extractResource().size());
+                if(sim->getPlayer().isInventoryFull())
+                {
+                    sim->reset();
+                    sim->startMining(name);
+                }
+            }
+            sim->clearEvents();
+        }});
+    }
+
+    //vault sized inventories show whether the cost stays flat as the slot count grows
+    const ObjectId probe = static_cast<ObjectId>(content.objectCount() - 1);
+    for(size_t slots : {INVENTORY_SIZE, size_t{4096}})
+        for(int percent : {0, 50, 90, 100})
+        {
+            std::string suffix = "/slots_" + std::to_string(slots) + "/fill_" + std::to_string(percent);
+            auto player = std::make_shared<Player>(filled_player(slots, percent / 100.0, content.objectCount(), probe));
+            //adding then taking the item back out keeps the fill level where it was
+            benchmarks.push_back({"player/addItem" + suffix, [player, probe](std::uint64_t n)
+            {
+                for(std::uint64_t i=0; i<n; i++)
+                {
+                    std::optional<size_t> slot = player->addItem(probe);
+                    keep(slot);
+                    if(slot)
+                        player->removeItemAt(*slot);
+                }
+            }});
+            benchmarks.push_back({"player/hasInInventory/miss" + suffix, [player, probe](std::uint64_t n)
+            {
+                for(std::uint64_t i=0; i<n; i++)
+                    keep(player->hasInInventory(probe));
+            }});
+            if(percent > 0)
+            {
+                ObjectId held = *player->getInventory().at(0);
+                benchmarks.push_back({"player/hasInInventory/hit" + suffix, [player, held](std::uint64_t n)
+                {
+                    for(std::uint64_t i=0; i<n; i++)
+                        keep(player->hasInInventory(held));
+                }});
+            }
+        }
+
+    //every drop rate in the game, read through a volatile so the constexpr call is not folded away
+    auto rates = std::make_shared<std::vector<int>>();
+    for(size_t r=0; r<content.resourceCount(); r++)
+        for(int drop_rate : content.drops(static_cast<ResourceId>(r)).drop_rates)
+            rates->push_back(drop_rate);
+    benchmarks.push_back({"data/drop_rate_to_rarity", [rates](std::uint64_t n)
+    {
+        const volatile int *data = rates->data();
+        size_t size = rates->size();
+        size_t index = 0;
+        for(std::uint64_t i=0; i<n; i++)
+        {
+            keep(drop_rate_to_rarity(data[index]));
+            index = (index + 1 == size) ? 0 : index + 1;
+        }
+    }});
+
+    //startup cost of a content table far larger than the game's, and key lookups in it as a load does
+    auto text = std::make_shared<std::string>(synthetic_content(5000, 500, 8));
+    benchmarks.push_back({"content/parse/5000_objects_500_resources", [text](std::uint64_t n)
+    {
+        for(std::uint64_t i=0; i<n; i++)
+            keep(Content::parse(*text, "synthetic").get());
+    }});
+    std::shared_ptr<const Content> large = Content::parse(*text, "synthetic");
+    benchmarks.push_back({"content/findObject/5000_objects", [large](std::uint64_t n)
+    {
+        const std::array<std::string_view, 4> keys = {"object_0", "object_2499", "object_4999", "missing"};
+        for(std::uint64_t i=0; i<n; i++)
+            keep(large->findObject(keys[i % keys.size()]));
+    }});
+
+    //chunks generated as a camera moving over a fresh world would ask for them, and tiles looked up at random
+    //in a world of 2048 x 2048 tiles, as clicks and hovers do
+    benchmarks.push_back({"world/generate/chunk", [](std::uint64_t n)
+    {
+        WorldMap world;
+        world.reset(DEFAULT_RNG_SEED, 4);
+        const size_t count = world.chunksX() * world.chunksY();
+        for(std::uint64_t i=0; i<n; i++)
+        {
+            if(i % count == 0 && i > 0)
+                world.reset(DEFAULT_RNG_SEED, 4);
+            keep(world.chunk(i % count % world.chunksX(), i % count / world.chunksX()).tiles[0]);
+        }
+    }});
+    auto world = std::make_shared<WorldMap>();
+    world->reset(DEFAULT_RNG_SEED, content.resourceCount());
+    //generated up front, or calibration would time generating the chunks and size the batches from that
+    for(size_t cy=0; cy<world->chunksY(); cy++)
+        for(size_t cx=0; cx<world->chunksX(); cx++)
+            keep(world->chunk(cx, cy).tiles[0]);
+    benchmarks.push_back({"world/resourceAt/2048x2048", [world](std::uint64_t n)
+    {
+        std::uint32_t point = 12345;
+        for(std::uint64_t i=0; i<n; i++)
+        {
+            point = point * 1664525u + 1013904223u;
+            keep(world->resourceAt((point >> 8) % world->tilesX(), (point >> 20) % world->tilesY()));
+        }
+    }});
+}
+
+#ifdef SKILLQUEST_BENCH_RENDER
+//the RUNNING screens of the game drawn by SDL's software renderer into an offscreen surface of the window's size
+class RenderBench
+{
+    SDL_Surface *surface = nullptr;
+    SDL_Renderer *renderer = nullptr;
+    TTF_Font *font = nullptr;
+    bool ttf = false;
+
+    public:
+        TextureManager texture_manager;
+        TextCache text_cache;
+        GameScreen game_screen = GameScreen(GS_X, GS_Y, GS_W, GS_H);
+        //the world alone, as far out as the camera zooms
+        GameScreen zoomed_out_screen = GameScreen(GS_X, GS_Y, GS_W, GS_H);
+        TextScreen text_screen = TextScreen(TS_X, TS_Y, TS_W, TS_H);
+        IconScreen icons_screen = IconScreen(IS_X, IS_Y, IS_W, IS_H);
+        UIScreen ui_screen = UIScreen(UIS_X, UIS_Y, UIS_W, UIS_H);
+        Simulation simulation = Simulation();
+        MessageLog log;
+        InventoryView inventory;
+        std::shared_ptr<const Content> content;
+
+        RenderBench(){}
+
+        RenderBench(const RenderBench&) = delete;
+        RenderBench& operator=(const RenderBench&) = delete;
+
+        ~RenderBench()
+        {
+            game_screen.releaseCache();
+            zoomed_out_screen.releaseCache();
+            text_screen.releaseCache();
+            icons_screen.releaseCache();
+            ui_screen.releaseCache();
+            texture_manager.destroy();
+            text_cache.clear();
+            if(font)
+                TTF_CloseFont(font);
+            if(ttf)
+                TTF_Quit();
+            if(renderer)
+                SDL_DestroyRenderer(renderer);
+            if(surface)
+                SDL_DestroySurface(surface);
+        }
+
+        bool init()
+        {
+            surface = SDL_CreateSurface(static_cast<int>(SCREEN_WIDTH), static_cast<int>(SCREEN_HEIGHT), SDL_PIXELFORMAT_RGBA32);
+            if(!surface)
+            {
+                std::cerr<<"Failed to create surface: "<<SDL_GetError()<<"\n";
+                return false;
+            }
+            renderer = SDL_CreateSoftwareRenderer(surface);
+            if(!renderer)
+            {
+                std::cerr<<"Failed to create software renderer: "<<SDL_GetError()<<"\n";
+                return false;
+            }
+            ttf = TTF_Init();
+            if(!ttf)
+            {
+                std::cerr<<"Failed to initialize TTF: "<<SDL_GetError()<<"\n";
+                return false;
+            }
+            font = TTF_OpenFont(FONT_PATH, FONT_SIZE);
+            if(!font)
+            {
+                std::cerr<<"Failed to open font: "<<SDL_GetError()<<"\n";
+                return false;
+            }
+            text_cache.bind(renderer, font);
+            std::unique_ptr<Content> built_in = Content::builtIn();
+            built_in->assignSprites();
+            content = std::move(built_in);
+            game_screen.setContent(*content);
+            zoomed_out_screen.setContent(*content);
+            zoomed_out_screen.zoomAt(GS_X + GS_W / 2.0f, GS_Y + GS_H / 2.0f, -100.0f);
+            AssetLoader assets;
+            assets.start();
+            assets.wait();
+            if(!texture_manager.buildAtlas(renderer, assets.getSurfaces()))
+            {
+                std::cerr<<"Failed to build sprite atlas: "<<SDL_GetError()<<"\n";
+                return false;
+            }
+
+            //mid game: mining with a part filled inventory and a full message history
+            simulation.seed(DEFAULT_RNG_SEED);
+            const ResourceId first = ResourceId{};
+            const ResourceDrops drops = content->drops(first);
+            simulation.setContent(content);
+            simulation.startMining(first);
+            while(simulation.getPlayer().getInventory().getOccupancy() < INVENTORY_SIZE / 2)
+                simulation.tick();
+            simulation.clearEvents();
+            inventory.assign(simulation.getPlayer().getInventory(), simulation.getPlayer().getInventoryRevision());
+            for(size_t i=0; i<LOG_HISTORY; i++)
+                log.mineSuccess(drops.objects[0], drops.rarities[0]);
+            text_screen.update(log, text_cache, *content);
+            ui_screen.setState(UIState::INVENTORY);
+            return true;
+        }
+
+        //same as Game::renderFrame in the RUNNING state, with the snapshot's parts kept here
+        void renderFrame(float fraction)
+        {
+            SDL_SetRenderDrawColor(renderer, BLACK.r, BLACK.g, BLACK.b, BLACK.a);
+            SDL_RenderClear(renderer);
+            game_screen.render(renderer, texture_manager, *content);
+            if(simulation.getPlayerTarget())
+                game_screen.renderTickProgress(renderer, *simulation.getPlayerTarget(), fraction);
+            game_screen.renderHover(renderer);
+            text_screen.render(renderer, text_cache);
+            icons_screen.render(renderer);
+            ui_screen.render(renderer, inventory, texture_manager, *content);
+            ui_screen.renderHover(renderer, inventory);
+            SDL_RenderPresent(renderer);
+        }
+
+        //the camera moved by (dx, dy) screen pixels and the world screen drawn again
+        void renderPan(GameScreen& screen, float dx, float dy)
+        {
+            SDL_SetRenderDrawColor(renderer, BLACK.r, BLACK.g, BLACK.b, BLACK.a);
+            SDL_RenderClear(renderer);
+            screen.pan(dx, dy);
+            screen.render(renderer, texture_manager, *content);
+            SDL_RenderPresent(renderer);
+        }
+
+        void markDirty() noexcept
+        {
+            game_screen.markDirty();
+            text_screen.markDirty();
+            icons_screen.markDirty();
+            ui_screen.markDirty();
+        }
+};
+
+void add_render_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+    auto bench = std::make_shared<RenderBench>();
+    if(!bench->init())
+    {
+        std::cerr<<"Skipping render benchmarks\n";
+        return;
+    }
+
+    //laying out one message into the scrollback ring, the words are only rasterized when the screen is drawn
+    const ResourceDrops drops = bench->content->drops(ResourceId{});
+    const LogMessage mined = {MessageId::MINED, static_cast<std::uint16_t>(drops.objects[0]), drops.rarities[0]};
+    benchmarks.push_back({"text/pushMessage", [bench, mined](std::uint64_t n)
+    {
+        for(std::uint64_t i=0; i<n; i++)
+            bench->text_screen.pushMessage(mined, bench->text_cache, *bench->content);
+    }});
+    //two logs of another generation each, so every update lays the whole history out again, as after a load
+    auto other = std::make_shared<MessageLog>();
+    other->clear();
+    for(size_t i=0; i<LOG_HISTORY; i++)
+        other->mineSuccess(drops.objects[0], drops.rarities[0]);
+    benchmarks.push_back({"text/update/full_history", [bench, other](std::uint64_t n)
+    {
+        for(std::uint64_t i=0; i<n; i++)
+            bench->text_screen.update(i % 2 ? bench->log : *other, bench->text_cache, *bench->content);
+    }});
+
+    //hit testing the mouse against a grid of a million boxes, as every mouse motion does
+    const GridLayout grid(0.0f, 0.0f, 35000.0f, 35000.0f, 1000, 1000, 1000000);
+    benchmarks.push_back({"grid/cellAt/1000000_cells", [grid](std::uint64_t n)
+    {
+        std::uint32_t point = 12345;
+        for(std::uint64_t i=0; i<n; i++)
+        {
+            point = point * 1664525u + 1013904223u;
+            keep(grid.cellAt(static_cast<float>(point >> 16) * 0.5f, static_cast<float>(point & 0xFFFF) * 0.5f));
+        }
+    }});
+
+    //every screen blitted from its cache, only the progress bar is drawn fresh
+    benchmarks.push_back({"render/frame/clean", [bench](std::uint64_t n)
+    {
+        for(std::uint64_t i=0; i<n; i++)
+            bench->renderFrame(static_cast<float>(i % 60) / 60.0f);
+    }});
+    //every screen redrawn into its cache first, the cost of a frame after a drop changed everything
+    benchmarks.push_back({"render/frame/dirty", [bench](std::uint64_t n)
+    {
+        for(std::uint64_t i=0; i<n; i++)
+        {
+            bench->markDirty();
+            bench->renderFrame(static_cast<float>(i % 60) / 60.0f);
+        }
+    }});
+
+    //panning back and forth by a few pixels a frame, every frame redraws the chunks in view from their meshes and
+    //builds those of the chunks coming into view
+    for(bool zoomed_out : {false, true})
+    {
+        benchmarks.push_back({zoomed_out ? "render/world/pan_zoomed_out" : "render/world/pan", [bench, zoomed_out](std::uint64_t n)
+        {
+            GameScreen& screen = zoomed_out ? bench->zoomed_out_screen : bench->game_screen;
+            for(std::uint64_t i=0; i<n; i++)
+                bench->renderPan(screen, (i / 256) % 2 ? -7.0f : 7.0f, (i / 256) % 2 ? -3.0f : 3.0f);
+        }});
+    }
+
+    //every sprite into a surface, as the game does while its menus are shown; the bundle is only there once
+    //the asset_packer target has run
+    AssetBundle bundle;
+    if(bundle.open(ASSET_BUNDLE_PATH))
+    {
+        benchmarks.push_back({"startup/sprites/bundle", [](std::uint64_t n)
+        {
+            for(std::uint64_t i=0; i<n; i++)
+            {
+                AssetLoader assets;
+                assets.start(ASSET_BUNDLE_PATH);
+                assets.wait();
+                keep(assets.getSurfaces().data());
+            }
+        }});
+    }
+    for(unsigned threads : {1u, 0u})
+    {
+        benchmarks.push_back({std::string("startup/sprites/png/") + (threads ? "1_thread" : "all_threads"), [threads](std::uint64_t n)
+        {
+            for(std::uint64_t i=0; i<n; i++)
+            {
+                AssetLoader assets;
+                assets.start("", threads);
+                assets.wait();
+                keep(assets.getSurfaces().data());
+            }
+        }});
+    }
+}
+
+//idle frames paced by FrameScheduler as the game's render loop does, reported as three results so a baseline
+//catches a pacing regression: the mean interval, the jitter (see FrameScheduler::getJitterNs) and the CPU time
+//the process spends per frame, which is the wait's spin when nothing else runs
+void measure_pacing(std::vector<BenchResult>& results, const Options& options)
+{
+    const std::array<std::string, 3> names = {"frame/pacing/interval", "frame/pacing/jitter", "frame/pacing/cpu_per_frame"};
+    bool wanted = false;
+    for(const std::string& name : names)
+        if(name.find(options.filter) != std::string::npos)
+        {
+            wanted = true;
+            if(options.list)
+                std::cout<<name<<"\n";
+        }
+    if(!wanted || options.list)
+        return;
+
+    FrameScheduler scheduler(FRAME_NS);
+    scheduler.start();
+    //a second of frames lets the spin settle on how late this machine's sleeps wake
+    for(Uint64 i=0; i<FPS; i++)
+    {
+        scheduler.beginFrame();
+        scheduler.waitForNextFrame();
+    }
+    scheduler.start();
+    std::clock_t cpu_start = std::clock();
+    for(size_t i=0; i<FRAME_HISTORY; i++)
+    {
+        scheduler.beginFrame();
+        scheduler.waitForNextFrame();
+    }
+    double cpu_ns = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC * 1e9 / FRAME_HISTORY;
+    const std::array<double, 3> values = {static_cast<double>(scheduler.getMeanFrameNs()), static_cast<double>(scheduler.getJitterNs()), cpu_ns};
+    for(size_t i=0; i<names.size(); i++)
+        if(names[i].find(options.filter) != std::string::npos)
+        {
+            results.push_back({names[i], FRAME_HISTORY, values[i], values[i], values[i]});
+            print_result(results.back());
+        }
+}
+#endif
+
+bool parse_options(int argc, char **argv, Options& options)
+{
+    for(int i=1; i<argc; i++)
+    {
+        std::string_view arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "--list")
+            options.list = true;
+        else if(arg == "--json" && has_value)
+            options.json_path = argv[++i];
+        else if(arg == "--filter" && has_value)
+            options.filter = argv[++i];
+        else if(arg == "--min-time" && has_value)
+            options.min_time = std::atof(argv[++i]);
+        else if(arg == "--baseline" && has_value)
+            options.baseline = argv[++i];
+        else if(arg == "--threshold" && has_value)
+            options.threshold = std::atof(argv[++i]);
+        else
+        {
+            std::cerr<<"usage: benchmarks [--json PATH] [--filter TEXT] [--min-time SECONDS] [--baseline PATH] [--threshold FRACTION] [--list]\n";
+            return false;
+        }
+    }
+    return options.min_time > 0.0;
+}
+
+bool write_json(const std::string& path, const std::vector<BenchResult>& results, bool render)
+{
+    std::ofstream file(path);
+    if(!file)
+        return false;
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    file<<"{\n  \"context\": {\"date\": \""<<date<<"\", \"build_type\": \""<<SKILLQUEST_BUILD_TYPE
+        <<"\", \"compiler\": \""<<BENCH_COMPILER<<"\", \"render\": "<<(render ? "true" : "false")<<"},\n";
+    //one benchmark per line, which is what read_baseline relies on
+    file<<"  \"benchmarks\": [\n";
+    char line[512];
+    for(size_t i=0; i<results.size(); i++)
+    {
+        const BenchResult& result = results[i];
+        std::snprintf(line, sizeof(line), "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f}%s\n",
+            result.name.c_str(), static_cast<unsigned long long>(result.iterations), result.ns_per_op, result.min_ns, result.max_ns,
+            i + 1 < results.size() ? "," : "");
+        file<<line;
+    }
+    file<<"  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+//name to ns_per_op from a file written by write_json
+std::unordered_map<std::string, double> read_baseline(const std::string& path)
+{
+    std::unordered_map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string line;
+    constexpr std::string_view name_key = "\"name\": \"";
+    constexpr std::string_view time_key = "\"ns_per_op\": ";
+    while(std::getline(file, line))
+    {
+        size_t name = line.find(name_key);
+        size_t time = line.find(time_key);
+        if(name == std::string::npos || time == std::string::npos)
+            continue;
+        name += name_key.size();
+        size_t name_end = line.find('"', name);
+        if(name_end == std::string::npos)
+            continue;
+        baseline[line.substr(name, name_end - name)] = std::atof(line.c_str() + time + time_key.size());
+    }
+    return baseline;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if(!parse_options(argc, argv, options))
+        return 1;
+
+    std::vector<Benchmark> benchmarks;
+    add_core_benchmarks(benchmarks);
+    bool render = false;
+#ifdef SKILLQUEST_BENCH_RENDER
+    size_t core_count = benchmarks.size();
+    add_render_benchmarks(benchmarks);
+    render = benchmarks.size() > core_count;
+#endif
+
+    std::vector<BenchResult> results;
+    for(const Benchmark& bench : benchmarks)
+    {
+        if(bench.name.find(options.filter) == std::string::npos)
+            continue;
+        if(options.list)
+        {
+            std::cout<<bench.name<<"\n";
+            continue;
+        }
+        results.push_back(measure(bench, options.min_time));
+        print_result(results.back());
+    }
+#ifdef SKILLQUEST_BENCH_RENDER
+    measure_pacing(results, options);
+#endif
+    if(options.list)
+        return 0;
+
+    if(!write_json(options.json_path, results, render))
+    {
+        std::cerr<<"Failed to write "<<options.json_path<<"\n";
+        return 1;
+    }
+    std::cout<<"wrote "<<results.size()<<" results to "<<options.json_path<<"\n";
+
+    if(options.baseline.empty())
+        return 0;
+    std::unordered_map<std::string, double> baseline = read_baseline(options.baseline);
+    if(baseline.empty())
+    {
+        std::cerr<<"No results in baseline "<<options.baseline<<"\n";
+        return 1;
+    }
+    std::cout<<"\ncompared with "<<options.baseline<<"\n";
+    bool regressed = false;
+    for(const BenchResult& result : results)
+    {
+        auto it = baseline.find(result.name);
+        if(it == baseline.end() || it->second <= 0.0)
+            continue;
+        double change = result.ns_per_op / it->second - 1.0;
+        bool slower = change > options.threshold;
+        regressed = regressed || slower;
+        std::printf("%-52s %+7.1f%%%s\n", result.name.c_str(), change * 100.0, slower ? "  REGRESSION" : "");
+    }
+    return regressed ? 3 : 0;
+}
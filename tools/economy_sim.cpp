@@ -0,0 +1,296 @@
+//Monte Carlo economy simulator for balancing drop rates
+//mines every resource for the given number of player hours, split over all cores, through the same
+//Simulation::tick the game runs, and reports time to fill the inventory, yield per hour and the rarity mix;
+//--validate also checks the sampled drop rates of every object against 1/drop_rate with a chi-square test;
+//--content balances a content table (see src/content.h) instead of the built in one
+//
+//usage: economy_sim [--hours H] [--threads N] [--seed S] [--inventory N] [--resource KEY] [--content FILE] [--validate]
+
+#include "../src/simulation.h"
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+//fill times at or above this many ticks share the last histogram bucket
+constexpr std::uint64_t MAX_FILL_TICKS = 1 << 16;
+constexpr std::uint64_t TICKS_PER_HOUR = 3600 * 1000 / TICK;
+constexpr int HISTOGRAM_ROWS = 16;
+constexpr int HISTOGRAM_WIDTH = 50;
+
+struct Options
+{
+    double hours = 100000.0;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed = DEFAULT_RNG_SEED;
+    size_t inventory = INVENTORY_SIZE;
+    std::optional<ResourceId> resource;
+    std::shared_ptr<const Content> content = Content::defaults();
+    bool validate = false;
+};
+
+struct ResourceStats
+{
+    std::uint64_t ticks = 0;
+    std::uint64_t fills = 0;
+    std::vector<std::uint64_t> yield; //by ObjectId
+    std::array<std::uint64_t, RARITY_COUNT> rarity{};
+    std::vector<std::uint64_t> fill_ticks = std::vector<std::uint64_t>(MAX_FILL_TICKS + 1, 0);
+
+    explicit ResourceStats(size_t objects) : yield(objects, 0)
+    {}
+
+    void merge(const ResourceStats& other)
+    {
+        ticks += other.ticks;
+        fills += other.fills;
+        for(size_t i=0; i<yield.size(); i++)
+            yield[i] += other.yield[i];
+        for(size_t i=0; i<RARITY_COUNT; i++)
+            rarity[i] += other.rarity[i];
+        for(size_t i=0; i<fill_ticks.size(); i++)
+            fill_ticks[i] += other.fill_ticks[i];
+    }
+
+    //smallest fill time with at least the given fraction of fills at or below it
+    std::uint64_t percentile(double fraction) const
+    {
+        std::uint64_t target = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(fills)));
+        std::uint64_t seen = 0;
+        for(size_t i=0; i<fill_ticks.size(); i++)
+        {
+            seen += fill_ticks[i];
+            if(seen >= std::max<std::uint64_t>(target, 1))
+                return i;
+        }
+        return MAX_FILL_TICKS;
+    }
+};
+
+//mines one resource for the given number of ticks, emptying the inventory every time it fills up
+void mine(const Options& options, ResourceId resource, std::uint64_t ticks, std::uint64_t seed, ResourceStats& stats)
+{
+    Simulation sim(options.inventory);
+    sim.setContent(options.content);
+    sim.seed(seed);
+    sim.startMining(resource);
+    sim.clearEvents();
+    std::uint64_t since_start = 0;
+    for(std::uint64_t t=0; t<ticks; t++)
+    {
+        sim.tick();
+        since_start++;
+        bool full = false;
+        for(const SimEvent& event : sim.getEvents())
+        {
+            if(event.type == SimEventType::MINED)
+            {
+                stats.yield[static_cast<size_t>(event.object)]++;
+                stats.rarity[static_cast<size_t>(event.rarity)]++;
+            }
+            else if(event.type == SimEventType::INVENTORY_FULL)
+                full = true;
+        }
+        sim.clearEvents();
+        if(full)
+        {
+            //mining stops on the tick after the one that filled the last slot
+            stats.fill_ticks[std::min(since_start - 1, MAX_FILL_TICKS)]++;
+            stats.fills++;
+            sim.reset();
+            sim.startMining(resource);
+            sim.clearEvents();
+            since_start = 0;
+        }
+    }
+    stats.ticks += ticks;
+}
+
+//ticks per thread so the threads together cover the requested hours
+std::uint64_t split_ticks(const Options& options, unsigned thread)
+{
+    std::uint64_t total = static_cast<std::uint64_t>(options.hours * static_cast<double>(TICKS_PER_HOUR));
+    return total / options.threads + (thread < total % options.threads ? 1 : 0);
+}
+
+//every thread of every resource gets its own seed, so results only depend on --seed and --threads
+std::uint64_t thread_seed(const Options& options, ResourceId resource, unsigned thread)
+{
+    std::uint64_t state = options.seed ^ (static_cast<std::uint64_t>(resource) << 32) ^ thread;
+    return splitmix64(state);
+}
+
+void print_report(const Content& content, ResourceId resource, const ResourceStats& stats)
+{
+    double hours = static_cast<double>(stats.ticks) / static_cast<double>(TICKS_PER_HOUR);
+    std::cout<<"\n== "<<content.name(resource)<<" ("<<hours<<" player hours, "<<stats.fills<<" full inventories)\n";
+
+    std::cout<<"yield per hour\n";
+    ResourceDrops table = content.drops(resource);
+    for(size_t i=0; i<table.size(); i++)
+    {
+        ObjectId object = table.objects[i];
+        std::cout<<"  "<<content.name(object)<<": "<<static_cast<double>(stats.yield[static_cast<size_t>(object)]) / hours
+            <<" (1/"<<table.drop_rates[i]<<", "<<rarity_to_string(table.rarities[i])<<")\n";
+    }
+
+    std::uint64_t drops = 0;
+    for(std::uint64_t count : stats.rarity)
+        drops += count;
+    std::cout<<"rarity mix\n";
+    for(size_t i=0; i<RARITY_COUNT; i++)
+        if(stats.rarity[i] > 0)
+            std::cout<<"  "<<rarity_to_string(static_cast<Rarity>(i))<<": "<<100.0 * static_cast<double>(stats.rarity[i]) / static_cast<double>(drops)<<"%\n";
+
+    if(stats.fills == 0)
+        return;
+    auto minutes = [](std::uint64_t ticks)
+    {
+        return static_cast<double>(ticks * TICK) / 60000.0;
+    };
+    std::cout<<"minutes to full inventory: p1 "<<minutes(stats.percentile(0.01))<<", p10 "<<minutes(stats.percentile(0.10))
+        <<", p50 "<<minutes(stats.percentile(0.50))<<", p90 "<<minutes(stats.percentile(0.90))
+        <<", p99 "<<minutes(stats.percentile(0.99))<<"\n";
+
+    //histogram between p1 and p99 so a long tail does not squash it
+    std::uint64_t low = stats.percentile(0.01);
+    std::uint64_t high = stats.percentile(0.99) + 1;
+    std::uint64_t step = std::max<std::uint64_t>((high - low + HISTOGRAM_ROWS - 1) / HISTOGRAM_ROWS, 1);
+    std::vector<std::uint64_t> rows;
+    for(std::uint64_t start = low; start < high; start += step)
+    {
+        std::uint64_t count = 0;
+        for(std::uint64_t i = start; i < std::min(start + step, high); i++)
+            count += stats.fill_ticks[i];
+        rows.push_back(count);
+    }
+    std::uint64_t peak = *std::max_element(rows.begin(), rows.end());
+    for(size_t row=0; row<rows.size(); row++)
+    {
+        std::uint64_t start = low + row * step;
+        int bar = peak ? static_cast<int>(rows[row] * HISTOGRAM_WIDTH / peak) : 0;
+        std::printf("  %7.1f min |%s\n", minutes(start), std::string(static_cast<size_t>(bar), '#').c_str());
+    }
+}
+
+//draws ticks straight from the resource's drop sampler, without an inventory in the way, and compares how
+//often each object dropped with 1/drop_rate; returns false if any resource fails at the 99.9% level
+bool validate(const Content& content, ResourceId resource, std::uint64_t ticks, std::uint64_t seed)
+{
+    const DropSampler& sampler = content.sampler(resource);
+    ResourceDrops drops = content.drops(resource);
+    Rng rng(seed);
+    std::array<std::uint64_t, MAX_RESOURCE_DROPS> counts{};
+    for(std::uint64_t tick = sampler.ticksToNextDrop(rng, ticks + 1); tick <= ticks; tick += sampler.ticksToNextDrop(rng, ticks + 1))
+        sampler.sampleDropTick(rng, [&counts](size_t i)
+        {
+            counts[i]++;
+            return true;
+        });
+
+    double chi2 = 0.0;
+    for(size_t i=0; i<drops.size(); i++)
+    {
+        double chance = 1.0 / drops.drop_rates[i];
+        double expected = static_cast<double>(ticks) * chance;
+        double variance = expected * (1.0 - chance);
+        if(variance > 0.0)
+            chi2 += (static_cast<double>(counts[i]) - expected) * (static_cast<double>(counts[i]) - expected) / variance;
+    }
+    //Wilson-Hilferty approximation of the chi-square quantile, z = 3.09 for 99.9%
+    double df = static_cast<double>(drops.size());
+    double critical = df * std::pow(1.0 - 2.0 / (9.0 * df) + 3.09 * std::sqrt(2.0 / (9.0 * df)), 3.0);
+    bool ok = chi2 <= critical;
+    std::cout<<"  "<<content.name(resource)<<": chi2 "<<chi2<<" over "<<drops.size()<<" objects, limit "<<critical<<(ok ? " ok\n" : " FAILED\n");
+    return ok;
+}
+
+bool parse_options(int argc, char **argv, Options& options)
+{
+    std::string_view resource_key;
+    for(int i=1; i<argc; i++)
+    {
+        std::string_view arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "--validate")
+            options.validate = true;
+        else if(arg == "--hours" && has_value)
+            options.hours = std::atof(argv[++i]);
+        else if(arg == "--threads" && has_value)
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        else if(arg == "--seed" && has_value)
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--inventory" && has_value)
+            options.inventory = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else if(arg == "--resource" && has_value)
+            resource_key = argv[++i];
+        else if(arg == "--content" && has_value)
+        {
+            std::shared_ptr<const Content> content = Content::load(argv[++i]);
+            if(!content)
+                return false;
+            options.content = std::move(content);
+        }
+        else
+        {
+            std::cerr<<"usage: economy_sim [--hours H] [--threads N] [--seed S] [--inventory N] [--resource KEY] [--content FILE] [--validate]\n";
+            return false;
+        }
+    }
+    //looked up once the content is known, --content may come after --resource
+    if(!resource_key.empty())
+    {
+        options.resource = options.content->findResource(resource_key);
+        if(!options.resource)
+        {
+            std::cerr<<"Unknown resource "<<resource_key<<"\n";
+            return false;
+        }
+    }
+    return options.hours > 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if(!parse_options(argc, argv, options))
+        return 1;
+
+    const Content& content = *options.content;
+    std::vector<ResourceId> resources;
+    for(size_t r=0; r<content.resourceCount(); r++)
+        if(!options.resource || static_cast<ResourceId>(r) == *options.resource)
+            resources.push_back(static_cast<ResourceId>(r));
+
+    //one stats block per thread and resource, merged once everyone is done
+    std::vector<std::vector<ResourceStats>> stats(options.threads, std::vector<ResourceStats>(resources.size(), ResourceStats(content.objectCount())));
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for(unsigned t=0; t<options.threads; t++)
+        workers.emplace_back([&options, &resources, &stats, t]
+        {
+            for(size_t r=0; r<resources.size(); r++)
+                mine(options, resources[r], split_ticks(options, t), thread_seed(options, resources[r], t), stats[t][r]);
+        });
+    for(std::thread& worker : workers)
+        worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t total_ticks = 0;
+    for(size_t r=0; r<resources.size(); r++)
+    {
+        for(unsigned t=1; t<options.threads; t++)
+            stats[0][r].merge(stats[t][r]);
+        total_ticks += stats[0][r].ticks;
+        print_report(content, resources[r], stats[0][r]);
+    }
+    std::cout<<"\nsimulated "<<total_ticks<<" ticks in "<<seconds<<" s on "<<options.threads<<" threads ("
+        <<static_cast<double>(total_ticks) / seconds<<" ticks/s)\n";
+
+    if(!options.validate)
+        return 0;
+    std::cout<<"\ndrop rate check\n";
+    bool ok = true;
+    for(ResourceId resource : resources)
+        ok = validate(content, resource, static_cast<std::uint64_t>(options.hours * static_cast<double>(TICKS_PER_HOUR)), thread_seed(options, resource, options.threads)) && ok;
+    return ok ? 0 : 2;
+}